@@ -0,0 +1,91 @@
+#include "AccessionCodec.h"
+
+/**
+ * Reads the letters, "_", digits and version of the accession, failing as soon as it leaves that shape or a
+ * field doesn't fit its bits.
+ * @returns True if the accession was packed into key.
+ */
+bool AccessionCodec::pack(const char *accession, size_t length, unsigned long long &key) {
+	size_t i = 0;
+	unsigned long long letters = 0;
+	for (; i < length && i < 3 && accession[i] >= 'A' && accession[i] <= 'Z'; i++)
+		letters |= (unsigned long long)(accession[i] - 'A' + 1) << (5*(2 - i));
+	if (i == 0)
+		return false;
+
+	unsigned long long underscore = 0;
+	if (i < length && accession[i] == '_') {
+		underscore = 1;
+		i++;
+	}
+
+	size_t digits = 0;
+	unsigned long long number = 0;
+	for (; i < length && accession[i] >= '0' && accession[i] <= '9'; i++, digits++) {
+		if (digits == 12)
+			return false;
+		number = 10*number + (accession[i] - '0');
+	}
+	if (digits == 0)
+		return false;
+
+	unsigned long long version = 0;
+	if (i < length) {
+		if (accession[i] != '.' || i + 2 != length || accession[i + 1] < '0' || accession[i + 1] > '6')
+			return false;
+		version = accession[i + 1] - '0' + 1;
+	}
+
+	key = letters << 48 | underscore << 47 | (unsigned long long)digits << 43 | number << 3 | version;
+	return true;
+}
+
+unsigned long long AccessionCodec::encode(const std::string &accession) {
+	unsigned long long key;
+	if (pack(accession.data(), accession.size(), key))
+		return key;
+	return FALLBACK | (unsigned long long)fallback.insert(accession);
+}
+
+bool AccessionCodec::find(const std::string &accession, unsigned long long &key) const {
+	if (pack(accession.data(), accession.size(), key))
+		return true;
+	int id = fallback.get_id(accession);
+	key = FALLBACK | (unsigned long long)id;
+	return id >= 0;
+}
+
+std::string AccessionCodec::decode(unsigned long long key) const {
+	std::string accession;
+	decode(key, accession);
+	return accession;
+}
+
+void AccessionCodec::decode(unsigned long long key, std::string &accession) const {
+	if (key & FALLBACK)
+		accession += fallback.get_key(key & ~FALLBACK);
+	else
+		unpack(key, accession);
+}
+
+void AccessionCodec::unpack(unsigned long long key, std::string &accession) {
+	for (int l = 2; l >= 0; l--) {
+		int letter = (key >> (48 + 5*l)) & 31;
+		if (letter)
+			accession += (char)('A' + letter - 1);
+	}
+	if ((key >> 47) & 1)
+		accession += '_';
+
+	int digits = (key >> 43) & 15;
+	unsigned long long number = (key >> 3) & ((1ULL << 40) - 1);
+	size_t first = accession.size();
+	accession.append(digits, '0');
+	for (int d = digits - 1; d >= 0; d--, number /= 10)
+		accession[first + d] = '0' + number % 10;
+
+	if (key & 7) {
+		accession += '.';
+		accession += (char)('0' + (key & 7) - 1);
+	}
+}
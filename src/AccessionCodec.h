@@ -0,0 +1,46 @@
+#ifndef __ACCESSION_CODEC_H__
+#define __ACCESSION_CODEC_H__
+
+#include <string>
+#include "HashTable.h"
+
+/*Packs protein accessions into 64-bit keys. Accessions with the usual shape (1 to 3 capital letters, an optional "_",
+ *1 to 12 digits and an optional version from 0 to 6, e.g. EAA26069.1 or WP_012345678.1) are packed losslessly:
+ *
+ *  bit 63     0 (packed)
+ *  bits 48-62 the letters, 5 bits each (1 to 26, 0 when there are less than 3)
+ *  bit 47     "_"
+ *  bits 43-46 number of digits (keeps the leading zeros)
+ *  bits 3-42  the number
+ *  bits 0-2   version + 1, 0 when there is none
+ *
+ *Any other accession is kept in a fallback table and its key is bit 63 set plus its id in the table.*/
+class AccessionCodec {
+
+	HashTable fallback; //accessions that can't be packed
+
+	public:
+
+		static const unsigned long long FALLBACK = 1ULL << 63;
+
+		/*Returns the key of an accession, adding it to the fallback table if it can't be packed and is new*/
+		unsigned long long encode(const std::string &accession);
+
+		/*Looks up the key of an accession without adding it. Returns false if it is in the fallback table's
+		 *format and was never encoded*/
+		bool find(const std::string &accession, unsigned long long &key) const;
+
+		/*Returns the accession of a key*/
+		std::string decode(unsigned long long key) const;
+
+		/*Appends the accession of a key to a string (e.g. an output buffer)*/
+		void decode(unsigned long long key, std::string &accession) const;
+
+		/*Packs an accession with the usual shape into key. Returns false if it has another shape*/
+		static bool pack(const char *accession, size_t length, unsigned long long &key);
+
+		/*Appends the accession of a packed key (bit 63 clear) to a string*/
+		static void unpack(unsigned long long key, std::string &accession);
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include <cstdlib>
+#include <new>
+#include "Arena.h"
+
+static thread_local Arena *thread_arena = NULL;
+static thread_local unsigned long long heap_allocations = 0;
+
+Arena::Arena(size_t block_size)
+	: current_block(0), offset(0), block_size(block_size) {
+}
+
+Arena::~Arena() {
+	for (unsigned int i = 0; i < blocks.size(); i++)
+		std::free(blocks[i]);
+}
+
+/**
+ * Serves the request from the current block or, if it doesn't fit, from the next one with room for it
+ * (allocating a new block only when no kept block has).
+ * @returns Pointer to bytes of memory aligned to alignment.
+ */
+void *Arena::allocate(size_t bytes, size_t alignment) {
+	while (current_block < blocks.size()) {
+		size_t start = (offset + alignment - 1) & ~(alignment - 1);
+		if (start + bytes <= block_sizes[current_block]) {
+			offset = start + bytes;
+			return blocks[current_block] + start;
+		}
+		current_block++;
+		offset = 0;
+	}
+
+	size_t size = std::max(block_size, bytes + alignment);
+	char *block = static_cast<char *>(std::malloc(size));
+	if (!block)
+		throw std::bad_alloc();
+	heap_allocations++;
+	blocks.push_back(block);
+	block_sizes.push_back(size);
+	current_block = blocks.size() - 1;
+	offset = 0;
+	return allocate(bytes, alignment);
+}
+
+void Arena::reset() {
+	current_block = 0;
+	offset = 0;
+}
+
+size_t Arena::capacity() const {
+	size_t total = 0;
+	for (unsigned int i = 0; i < block_sizes.size(); i++)
+		total += block_sizes[i];
+	return total;
+}
+
+Arena *Arena::current() {
+	return thread_arena;
+}
+
+Arena::Scope::Scope(Arena *arena)
+	: previous(thread_arena) {
+	thread_arena = arena;
+}
+
+Arena::Scope::~Scope() {
+	thread_arena = previous;
+}
+
+void *Arena::heap_allocate(size_t bytes) {
+#ifndef COUNT_HEAP_ALLOCATIONS
+	heap_allocations++; //otherwise counted by operator new
+#endif
+	return ::operator new(bytes);
+}
+
+unsigned long long heap_allocation_count() {
+	return heap_allocations;
+}
+
+#ifdef COUNT_HEAP_ALLOCATIONS
+/*The global allocation functions are replaced only to count the heap allocations of each thread (a diagnostic
+ *build: the others keep the standard allocator)*/
+void *operator new(std::size_t size) {
+	heap_allocations++;
+	void *p = std::malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](std::size_t size) {
+	return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+	heap_allocations++;
+	return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+	return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+	std::free(p);
+}
+#endif
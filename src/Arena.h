@@ -0,0 +1,111 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <utility>
+#include <functional>
+#include <type_traits>
+
+/*Monotonic memory arena: allocations bump a pointer inside large blocks, deallocations do nothing and reset()
+ *makes all the memory available again while keeping the blocks. Each thread comparing neighborhoods owns one and
+ *resets it after every pair, so once its blocks are large enough the pair loop makes no heap allocations.*/
+class Arena {
+
+	private:
+		std::vector<char *> blocks;
+		std::vector<size_t> block_sizes;
+		size_t current_block; //block being filled
+		size_t offset;        //first free byte of the current block
+		size_t block_size;    //size of new blocks (larger requests get a block of their own size)
+
+	public:
+
+		/*Creates an arena without blocks. They are allocated on demand, block_size bytes at a time*/
+		Arena(size_t block_size = 1 << 20);
+
+		~Arena();
+
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+
+		/*Returns bytes of memory aligned to alignment, valid until the next reset()*/
+		void *allocate(size_t bytes, size_t alignment);
+
+		/*Makes all the memory of the arena available again, keeping its blocks*/
+		void reset();
+
+		/*Returns the number of bytes in the blocks of the arena*/
+		size_t capacity() const;
+
+		/*Returns the current arena of the calling thread, or NULL if it has none*/
+		static Arena *current();
+
+		/*Returns bytes of memory from the heap (operator new), counted by heap_allocation_count*/
+		static void *heap_allocate(size_t bytes);
+
+		/*Makes an arena (or the heap, if NULL) the current one of the calling thread while the object lives*/
+		class Scope {
+			Arena *previous;
+			public:
+				Scope(Arena *arena);
+				~Scope();
+		};
+};
+
+/*STL allocator over an Arena. Default-constructed allocators use the current arena of the thread (or the heap
+ *if there is none), so containers created while comparing a pair live in the arena of the comparing thread.
+ *Copies of containers are made in the current arena too (e.g. the rows of a matrix), so results that must outlive
+ *a reset are copied inside a Scope without arena.*/
+template <class T>
+class ArenaAllocator {
+
+	public:
+		typedef T value_type;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		Arena *arena; //NULL for the heap
+
+		ArenaAllocator() : arena(Arena::current()) {}
+
+		explicit ArenaAllocator(Arena *arena) : arena(arena) {}
+
+		template <class U>
+		ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+		T *allocate(size_t n) {
+			if (arena)
+				return static_cast<T *>(arena->allocate(n*sizeof(T), alignof(T)));
+			return static_cast<T *>(Arena::heap_allocate(n*sizeof(T)));
+		}
+
+		void deallocate(T *p, size_t) {
+			if (!arena)
+				::operator delete(p);
+		}
+
+		ArenaAllocator select_on_container_copy_construction() const {
+			return ArenaAllocator();
+		}
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {return a.arena == b.arena;}
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {return a.arena != b.arena;}
+
+template <class T>
+using arena_vector = std::vector<T, ArenaAllocator<T> >;
+
+/*Protein assignments between two neighborhoods: (index in g1, index in g2) -> weight (similarity*1000000)*/
+typedef std::map<std::pair<int, int>, int, std::less<std::pair<int, int> >,
+                 ArenaAllocator<std::pair<const std::pair<int, int>, int> > > assignments_t;
+
+/*Returns the number of heap allocations made by the calling thread so far for the arenas: their blocks and the
+ *allocations of ArenaAllocators without arena. Built with -DCOUNT_HEAP_ALLOCATIONS, every operator new is counted*/
+unsigned long long heap_allocation_count();
+
+#endif
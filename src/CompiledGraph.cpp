@@ -0,0 +1,501 @@
+#include "CompiledGraph.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ *Writes a section of the file, padded to 8 bytes
+ */
+static void write_section(std::ofstream &file, const void *section, size_t bytes) {
+	static const char padding[8] = {0};
+	file.write((const char *)section, bytes);
+	file.write(padding, (8 - bytes % 8) % 8);
+}
+
+static size_t padded(size_t bytes) {return (bytes + 7)/8*8;}
+
+CompiledGraph::CompiledGraph()
+	: data(NULL), size(0), proteins(0), max(0) {
+}
+
+CompiledGraph::~CompiledGraph() {
+	if (data)
+		munmap((void *)data, size);
+}
+
+/**
+ *Reads the similarities as protein_clustering does (the first similarity of each pair is kept), numbering the
+ *proteins in order of first appearance, and writes them as CSR adjacency lists sorted by id.
+ */
+void CompiledGraph::compile(const std::string &prot_sim_filename, const std::string &graph_filename) {
+	std::ifstream file;
+	std::string prot1;
+	std::string prot2;
+	std::string similarity;
+	AccessionCodec codec;
+	HashTable ids;
+	std::vector<unsigned long long> keys;
+	std::vector<edge_t> edges;
+
+	file.open(prot_sim_filename.c_str());
+	if (file.fail()) {
+		std::cerr << "ERROR: trouble opening the protein similarities file\n";
+		exit(1);
+	}
+	while(std::getline(file, prot1, ' ')) {
+		std::getline(file, prot2, ' ');
+		std::getline(file, similarity);
+		unsigned long long key1 = codec.encode(prot1), key2 = codec.encode(prot2);
+		unsigned int id1 = ids.insert(key1);
+		if (id1 == keys.size()) keys.push_back(key1);
+		unsigned int id2 = ids.insert(key2);
+		if (id2 == keys.size()) keys.push_back(key2);
+		edges.push_back(edge_t {std::max(id1, id2), std::min(id1, id2), std::stod(similarity)});
+	}
+	file.close();
+
+	//Keeps the first similarity of each pair
+	std::stable_sort(edges.begin(), edges.end(), edge_order);
+	edges.erase(std::unique(edges.begin(), edges.end(), [](const edge_t &a, const edge_t &b) {
+		return a.x == b.x && a.y == b.y;
+	}), edges.end());
+
+	//Adjacency lists: in the order of the edges, each list gets its neighbors in increasing order
+	double max_similarity = 0;
+	std::vector<unsigned long long> offsets(keys.size() + 1, 0);
+	for (size_t e = 0; e < edges.size(); e++) {
+		offsets[edges[e].x + 1]++;
+		if (edges[e].x != edges[e].y)
+			offsets[edges[e].y + 1]++;
+		max_similarity = std::max(max_similarity, edges[e].weight);
+	}
+	for (size_t i = 0; i < keys.size(); i++)
+		offsets[i + 1] += offsets[i];
+
+	std::vector<unsigned int> neighbors(offsets.back());
+	std::vector<double> weights(offsets.back());
+	std::vector<unsigned long long> next(offsets.begin(), offsets.end() - 1);
+	for (size_t e = 0; e < edges.size(); e++) {
+		neighbors[next[edges[e].x]] = edges[e].y;
+		weights[next[edges[e].x]++] = edges[e].weight;
+		if (edges[e].x == edges[e].y) continue;
+		neighbors[next[edges[e].y]] = edges[e].x;
+		weights[next[edges[e].y]++] = edges[e].weight;
+	}
+	std::vector<edge_t>().swap(edges);
+
+	write_graph(graph_filename, keys, codec, offsets, neighbors, weights, max_similarity);
+}
+
+/**
+ *Lookup tables: packed keys sorted by key, names sorted by name
+ */
+CompiledGraph::lookup_tables_t CompiledGraph::build_lookup(const std::vector<unsigned long long> &keys,
+                                                           const AccessionCodec &codec, unsigned long long first_id) {
+	lookup_tables_t tables;
+	for (size_t k = 0; k < keys.size(); k++) {
+		if (keys[k] & AccessionCodec::FALLBACK) {
+			unsigned long long index = keys[k] & ~AccessionCodec::FALLBACK;
+			if (index >= tables.name_ids.size())
+				tables.name_ids.resize(index + 1);
+			tables.name_ids[index] = first_id + k;
+		}
+		else
+			tables.packed.push_back(packed_t {keys[k], first_id + k});
+	}
+	std::sort(tables.packed.begin(), tables.packed.end(), [](const packed_t &a, const packed_t &b) {return a.key < b.key;});
+
+	std::vector<std::string> &name_list = tables.name_list;
+	name_list.resize(tables.name_ids.size());
+	tables.name_offsets.assign(1, 0);
+	tables.name_order.resize(tables.name_ids.size());
+	for (size_t f = 0; f < tables.name_ids.size(); f++) {
+		name_list[f] = codec.decode(AccessionCodec::FALLBACK | f);
+		tables.name_offsets.push_back(tables.name_offsets.back() + name_list[f].size());
+		tables.name_order[f] = f;
+	}
+	std::sort(tables.name_order.begin(), tables.name_order.end(), [&name_list](unsigned long long a, unsigned long long b) {
+		return name_list[a] < name_list[b];
+	});
+	return tables;
+}
+
+void CompiledGraph::write_lookup(std::ofstream &out, const lookup_tables_t &tables) {
+	write_section(out, tables.packed.data(), tables.packed.size()*sizeof(packed_t));
+	write_section(out, tables.name_offsets.data(), tables.name_offsets.size()*sizeof(unsigned long long));
+	write_section(out, tables.name_ids.data(), tables.name_ids.size()*sizeof(unsigned long long));
+	write_section(out, tables.name_order.data(), tables.name_order.size()*sizeof(unsigned long long));
+	std::string names;
+	for (size_t f = 0; f < tables.name_list.size(); f++)
+		names += tables.name_list[f];
+	write_section(out, names.data(), names.size());
+}
+
+void CompiledGraph::write_graph(const std::string &graph_filename, const std::vector<unsigned long long> &keys,
+                                const AccessionCodec &codec, const std::vector<unsigned long long> &offsets,
+                                const std::vector<unsigned int> &neighbors, const std::vector<double> &weights,
+                                double max_similarity) {
+	lookup_tables_t tables = build_lookup(keys, codec, 0);
+	header_t header;
+	memcpy(header.magic, "NCGRAPH1", 8);
+	header.proteins = keys.size();
+	header.similarities = offsets.back();
+	header.packed_proteins = tables.packed.size();
+	header.names = tables.name_ids.size();
+	header.name_bytes = tables.name_offsets.back();
+	header.max_similarity = max_similarity;
+
+	std::ofstream out(graph_filename.c_str(), std::ios::binary);
+	if (out.fail()) {
+		std::cerr << "ERROR: trouble opening the compiled graph file\n";
+		exit(1);
+	}
+	write_section(out, &header, sizeof(header));
+	write_section(out, keys.data(), keys.size()*sizeof(unsigned long long));
+	write_section(out, offsets.data(), offsets.size()*sizeof(unsigned long long));
+	write_section(out, neighbors.data(), neighbors.size()*sizeof(unsigned int));
+	write_section(out, weights.data(), weights.size()*sizeof(double));
+	write_lookup(out, tables);
+	out.close();
+	if (out.fail()) {
+		std::cerr << "ERROR: trouble writing the compiled graph file\n";
+		exit(1);
+	}
+}
+
+bool CompiledGraph::is_compiled(const std::string &filename) {
+	char magic[8];
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	return file.read(magic, 8) && memcmp(magic, "NCGRAPH1", 8) == 0;
+}
+
+/**
+ *Maps the file and finds its sections (see the file layout in CompiledGraph.h), then the ones of every segment after it
+ */
+void CompiledGraph::open(const std::string &graph_filename) {
+	int fd = ::open(graph_filename.c_str(), O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) < 0) {
+		std::cerr << "ERROR: trouble opening the compiled graph file\n";
+		exit(1);
+	}
+	size = info.st_size;
+	void *mapped = size >= sizeof(header_t) ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	::close(fd);
+	if (mapped == MAP_FAILED || memcmp(mapped, "NCGRAPH1", 8) != 0) {
+		std::cerr << "ERROR: " << graph_filename << " is not a compiled graph file\n";
+		exit(1);
+	}
+	data = (const char *)mapped;
+
+	const char *section = data;
+	header = (const header_t *)section;
+	section += padded(sizeof(header_t));
+	lookup_t base;
+	base.first_id = 0;
+	base.proteins = header->proteins;
+	base.packed_proteins = header->packed_proteins;
+	base.names = header->names;
+	base.keys = (const unsigned long long *)section;
+	section += padded(header->proteins*sizeof(unsigned long long));
+	offsets = (const unsigned long long *)section;
+	section += padded((header->proteins + 1)*sizeof(unsigned long long));
+	neighbors = (const unsigned int *)section;
+	section += padded(header->similarities*sizeof(unsigned int));
+	weights = (const double *)section;
+	section += padded(header->similarities*sizeof(double));
+	section = read_lookup(base, section, header->name_bytes);
+	if (base.names_text + header->name_bytes > data + size) {
+		std::cerr << "ERROR: " << graph_filename << " is truncated\n";
+		exit(1);
+	}
+	lookups.assign(1, base);
+	proteins = header->proteins;
+	max = header->max_similarity;
+
+	std::vector<const edge_t *> edges;
+	std::vector<unsigned long long> edge_counts;
+	while (section + sizeof(delta_header_t) <= data + size) {
+		const delta_header_t *delta = (const delta_header_t *)section;
+		if (memcmp(delta->magic, "NCDELTA1", 8) != 0 || delta->bytes > (size_t)(data + size - section)) {
+			std::cerr << "ERROR: " << graph_filename << " has a truncated or damaged segment\n";
+			exit(1);
+		}
+		const char *end = section + delta->bytes;
+		lookup_t lookup;
+		lookup.first_id = proteins;
+		lookup.proteins = delta->proteins;
+		lookup.packed_proteins = delta->packed_proteins;
+		lookup.names = delta->names;
+		section += padded(sizeof(delta_header_t));
+		lookup.keys = (const unsigned long long *)section;
+		section += padded(delta->proteins*sizeof(unsigned long long));
+		edges.push_back((const edge_t *)section);
+		edge_counts.push_back(delta->edges);
+		section += padded(delta->edges*sizeof(edge_t));
+		read_lookup(lookup, section, delta->name_bytes);
+		lookups.push_back(lookup);
+		proteins += delta->proteins;
+		max = delta->max_similarity;
+		section = end;
+	}
+	merge_segments(edges, edge_counts);
+}
+
+const char *CompiledGraph::read_lookup(lookup_t &lookup, const char *section, unsigned long long name_bytes) {
+	lookup.packed = (const packed_t *)section;
+	section += padded(lookup.packed_proteins*sizeof(packed_t));
+	lookup.name_offsets = (const unsigned long long *)section;
+	section += padded((lookup.names + 1)*sizeof(unsigned long long));
+	lookup.name_ids = (const unsigned long long *)section;
+	section += padded(lookup.names*sizeof(unsigned long long));
+	lookup.name_order = (const unsigned long long *)section;
+	section += padded(lookup.names*sizeof(unsigned long long));
+	lookup.names_text = section;
+	return section + padded(name_bytes);
+}
+
+/**
+ *The similarities of each protein with edges in the segments are the ones of its list in the base graph, replaced or
+ *extended by its edges in the segments, in order (the last one of a pair is kept).
+ */
+void CompiledGraph::merge_segments(const std::vector<const edge_t *> &edges,
+                                   const std::vector<unsigned long long> &edge_counts) {
+	overlay_slots.clear();
+	overlay_offsets.assign(1, 0);
+	overlay_neighbors.clear();
+	overlay_weights.clear();
+	if (edges.empty()) return;
+
+	//Each edge at both of its proteins, in the order of the segments
+	std::vector<edge_t> updates;
+	for (size_t s = 0; s < edges.size(); s++)
+		for (unsigned long long e = 0; e < edge_counts[s]; e++) {
+			updates.push_back(edges[s][e]);
+			if (edges[s][e].x != edges[s][e].y)
+				updates.push_back(edge_t {edges[s][e].y, edges[s][e].x, edges[s][e].weight});
+		}
+	std::stable_sort(updates.begin(), updates.end(), edge_order);
+
+	overlay_slots.assign(proteins, -1);
+	size_t u = 0;
+	for (unsigned long long id = 0; id < proteins; id++) {
+		if ((u == updates.size() || updates[u].x != id) && id < header->proteins) continue;
+		overlay_slots[id] = overlay_offsets.size() - 1;
+
+		const unsigned int *base_neighbors = id < header->proteins ? neighbors + offsets[id] : NULL;
+		const double *base_weights = id < header->proteins ? weights + offsets[id] : NULL;
+		unsigned long long k = 0, base_degree = id < header->proteins ? offsets[id + 1] - offsets[id] : 0;
+		for (; u < updates.size() && updates[u].x == id; u++) {
+			if (u + 1 < updates.size() && updates[u + 1].x == id && updates[u + 1].y == updates[u].y) continue; //later one kept
+			for (; k < base_degree && base_neighbors[k] < updates[u].y; k++) {
+				overlay_neighbors.push_back(base_neighbors[k]);
+				overlay_weights.push_back(base_weights[k]);
+			}
+			if (k < base_degree && base_neighbors[k] == updates[u].y) k++;
+			overlay_neighbors.push_back(updates[u].y);
+			overlay_weights.push_back(updates[u].weight);
+		}
+		for (; k < base_degree; k++) {
+			overlay_neighbors.push_back(base_neighbors[k]);
+			overlay_weights.push_back(base_weights[k]);
+		}
+		overlay_offsets.push_back(overlay_neighbors.size());
+	}
+}
+
+long CompiledGraph::similarity_count() const {
+	//Every similarity is stored twice, except the ones of a protein with itself
+	long entries = 0, self = 0;
+	for (unsigned long long id = 0; id < proteins; id++) {
+		const unsigned int *first = neighbors_of(id), *last = first + degree(id);
+		entries += degree(id);
+		self += std::binary_search(first, last, (unsigned int)id);
+	}
+	return (entries + self)/2;
+}
+
+double CompiledGraph::similarity(long id1, long id2) const {
+	const unsigned int *first = neighbors_of(id1), *last = first + degree(id1);
+	const unsigned int *found = std::lower_bound(first, last, (unsigned int)id2);
+	return found != last && *found == id2 ? weights_of(id1)[found - first] : -1;
+}
+
+std::string CompiledGraph::get_name(const lookup_t &lookup, unsigned long long index) const {
+	return std::string(lookup.names_text + lookup.name_offsets[index], lookup.name_offsets[index + 1] - lookup.name_offsets[index]);
+}
+
+/**
+ * Packed pids are found by binary search on their keys, the other ones on the sorted names, in the base graph and
+ * then in each segment.
+ * @returns Id of the protein or -1 if it is not in the graph.
+ */
+long CompiledGraph::find(const std::string &pid) const {
+	unsigned long long key;
+	bool is_packed = AccessionCodec::pack(pid.data(), pid.size(), key);
+	for (size_t l = 0; l < lookups.size(); l++) {
+		const lookup_t &lookup = lookups[l];
+		if (is_packed) {
+			const packed_t *last = lookup.packed + lookup.packed_proteins;
+			const packed_t *found = std::lower_bound(lookup.packed, last, key, [](const packed_t &p, unsigned long long k) {
+				return p.key < k;
+			});
+			if (found != last && found->key == key)
+				return found->id;
+			continue;
+		}
+
+		const unsigned long long *last = lookup.name_order + lookup.names;
+		const unsigned long long *found = std::lower_bound(lookup.name_order, last, pid, [this, &lookup](unsigned long long index, const std::string &name) {
+			return get_name(lookup, index) < name;
+		});
+		if (found != last && get_name(lookup, *found) == pid)
+			return lookup.name_ids[*found];
+	}
+	return -1;
+}
+
+std::string CompiledGraph::name(long id) const {
+	size_t l = lookups.size() - 1;
+	while (lookups[l].first_id > (unsigned long long)id)
+		l--;
+	unsigned long long key = lookups[l].keys[id - lookups[l].first_id];
+	if (key & AccessionCodec::FALLBACK)
+		return get_name(lookups[l], key & ~AccessionCodec::FALLBACK);
+	std::string pid;
+	AccessionCodec::unpack(key, pid);
+	return pid;
+}
+
+/**
+ *The proteins of the file are looked up in the graph; the ones that are not in it get the next ids, in order of first
+ *appearance. The segment is written after the end of the file, so the graph is never rewritten.
+ */
+unsigned long long CompiledGraph::append(const std::string &prot_sim_filename, const std::string &graph_filename) {
+	std::ifstream file;
+	std::string prot1;
+	std::string prot2;
+	std::string similarity;
+	AccessionCodec codec;
+	HashTable new_ids;
+	std::vector<unsigned long long> keys; //of the new proteins
+	std::vector<edge_t> edges;
+	delta_header_t header;
+	size_t graph_size;
+	unsigned long long first_id; //of the new proteins
+	{
+		CompiledGraph graph;
+		graph.open(graph_filename);
+		graph_size = graph.size;
+		first_id = graph.protein_count();
+
+		file.open(prot_sim_filename.c_str());
+		if (file.fail()) {
+			std::cerr << "ERROR: trouble opening the protein similarities file\n";
+			exit(1);
+		}
+		while(std::getline(file, prot1, ' ')) {
+			std::getline(file, prot2, ' ');
+			std::getline(file, similarity);
+			long id[2];
+			const std::string *pids[2] = {&prot1, &prot2};
+			for (int i = 0; i < 2; i++) {
+				id[i] = graph.find(*pids[i]);
+				if (id[i] >= 0) continue;
+				unsigned long long key = codec.encode(*pids[i]);
+				unsigned int index = new_ids.insert(key);
+				if (index == keys.size()) keys.push_back(key);
+				id[i] = graph.protein_count() + index;
+			}
+			edges.push_back(edge_t {(unsigned int)std::max(id[0], id[1]), (unsigned int)std::min(id[0], id[1]), std::stod(similarity)});
+		}
+		file.close();
+
+		//Keeps the first similarity of each pair, if it is new or changed
+		std::stable_sort(edges.begin(), edges.end(), edge_order);
+		edges.erase(std::unique(edges.begin(), edges.end(), [](const edge_t &a, const edge_t &b) {
+			return a.x == b.x && a.y == b.y;
+		}), edges.end());
+		bool lowers_max = false; //a largest similarity of the graph is changed to a smaller one
+		header.max_similarity = graph.max_similarity();
+		edges.erase(std::remove_if(edges.begin(), edges.end(), [&graph, &header, &lowers_max](const edge_t &e) {
+			double current = e.x < graph.protein_count() ? graph.similarity(e.x, e.y) : -1;
+			if (current == e.weight) return true;
+			lowers_max = lowers_max || (current == graph.max_similarity() && e.weight < current);
+			header.max_similarity = std::max(header.max_similarity, e.weight);
+			return false;
+		}), edges.end());
+
+		if (lowers_max) { //the largest similarity of the graph with the segment is looked for among all of them
+			header.max_similarity = 0;
+			for (size_t e = 0; e < edges.size(); e++)
+				header.max_similarity = std::max(header.max_similarity, edges[e].weight);
+			for (long id = 0; id < graph.protein_count(); id++)
+				for (long k = 0; k < graph.degree(id) && graph.neighbors_of(id)[k] <= id; k++) {
+					edge_t e = {(unsigned int)id, graph.neighbors_of(id)[k], 0};
+					if (!std::binary_search(edges.begin(), edges.end(), e, edge_order))
+						header.max_similarity = std::max(header.max_similarity, graph.weights_of(id)[k]);
+				}
+		}
+	}
+	if (edges.empty()) return 0;
+
+	lookup_tables_t tables = build_lookup(keys, codec, first_id);
+	memcpy(header.magic, "NCDELTA1", 8);
+	header.proteins = keys.size();
+	header.edges = edges.size();
+	header.packed_proteins = tables.packed.size();
+	header.names = tables.name_ids.size();
+	header.name_bytes = tables.name_offsets.back();
+	header.bytes = padded(sizeof(header)) + padded(keys.size()*sizeof(unsigned long long)) +
+	               padded(edges.size()*sizeof(edge_t)) + padded(tables.packed.size()*sizeof(packed_t)) +
+	               padded(tables.name_offsets.size()*sizeof(unsigned long long)) +
+	               2*padded(tables.name_ids.size()*sizeof(unsigned long long)) + padded(header.name_bytes);
+
+	std::ofstream out(graph_filename.c_str(), std::ios::binary | std::ios::app);
+	static const char padding[8] = {0};
+	out.write(padding, (8 - graph_size % 8) % 8);
+	write_section(out, &header, sizeof(header));
+	write_section(out, keys.data(), keys.size()*sizeof(unsigned long long));
+	write_section(out, edges.data(), edges.size()*sizeof(edge_t));
+	write_lookup(out, tables);
+	out.close();
+	if (out.fail()) {
+		std::cerr << "ERROR: trouble writing the compiled graph file\n";
+		exit(1);
+	}
+	return edges.size();
+}
+
+/**
+ *The graph is written with the merged adjacency lists to graph_filename followed by ".compact", which is then renamed
+ *over it.
+ */
+void CompiledGraph::compact(const std::string &graph_filename) {
+	AccessionCodec codec;
+	std::vector<unsigned long long> keys;
+	std::vector<unsigned long long> offsets(1, 0);
+	std::vector<unsigned int> neighbors;
+	std::vector<double> weights;
+	double max_similarity;
+	{
+		CompiledGraph graph;
+		graph.open(graph_filename);
+		for (long id = 0; id < graph.protein_count(); id++) {
+			keys.push_back(codec.encode(graph.name(id)));
+			neighbors.insert(neighbors.end(), graph.neighbors_of(id), graph.neighbors_of(id) + graph.degree(id));
+			weights.insert(weights.end(), graph.weights_of(id), graph.weights_of(id) + graph.degree(id));
+			offsets.push_back(neighbors.size());
+		}
+		max_similarity = graph.max_similarity();
+	}
+	write_graph(graph_filename + ".compact", keys, codec, offsets, neighbors, weights, max_similarity);
+	if (std::rename((graph_filename + ".compact").c_str(), graph_filename.c_str()) != 0) {
+		std::cerr << "ERROR: trouble writing the compiled graph file\n";
+		exit(1);
+	}
+}
@@ -0,0 +1,202 @@
+#ifndef __COMPILED_GRAPH_H__
+#define __COMPILED_GRAPH_H__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "AccessionCodec.h"
+#include "HashTable.h"
+
+/*Protein similarity graph compiled from a prot_sim_filename into a binary file, which is mapped into memory when
+ *opened: only the parts that are read (e.g. the similarities of the proteins of some neighborhoods) are loaded from
+ *disk. The proteins have ids 0, 1, 2, ... in order of first appearance in the prot_sim_filename (the same indexes of
+ *a ProteinCollection read from it) and each similarity is kept as read the first time its pair appears.
+ *
+ *File layout, 8-byte aligned sections one after the other:
+ *  header            magic "NCGRAPH1", then the counts below and the largest similarity (see header_t)
+ *  keys[proteins]    AccessionCodec key of each protein; the ones that can't be packed are FALLBACK | their name index
+ *  offsets[proteins + 1]   start of the similarities of each protein (CSR), followed by the end of the last one
+ *  neighbors[similarities] the other protein of each similarity (32 bits), sorted in each protein
+ *  weights[similarities]   the similarity itself (double)
+ *  packed[packed_proteins] (key, id) of the packed keys, sorted by key
+ *  name_offsets[names + 1], name_ids[names], name_order[names] (name indexes sorted by name), then the names
+ *Each similarity is stored at both of its proteins (once if a protein is similar to itself).
+ *
+ *Later similarities are appended to the file as immutable delta segments (see append), each one after the previous:
+ *  delta header      magic "NCDELTA1", then its size, the counts below and the largest similarity of the graph with it
+ *  keys[proteins]    of the proteins it adds, with the next ids
+ *  edges[edges]      (larger id, smaller id, similarity) of the similarities it adds or changes, sorted by ids
+ *  packed, name_offsets, name_ids, name_order and names of the proteins it adds, as above
+ *When the graph is opened, the similarities of the proteins with edges in the segments are merged into adjacency lists
+ *in memory (the similarity of the last segment is kept), so they are read as the other ones. compact folds the segments
+ *back into a single graph.*/
+class CompiledGraph {
+
+	struct header_t {
+		char magic[8];
+		unsigned long long proteins;
+		unsigned long long similarities;   //entries of neighbors and weights (each pair counts twice)
+		unsigned long long packed_proteins;
+		unsigned long long names;
+		unsigned long long name_bytes;
+		double max_similarity;
+	};
+
+	struct delta_header_t {
+		char magic[8];
+		unsigned long long bytes;          //of the whole segment, header included
+		unsigned long long proteins;
+		unsigned long long edges;
+		unsigned long long packed_proteins;
+		unsigned long long names;
+		unsigned long long name_bytes;
+		double max_similarity;             //of the graph up to this segment
+	};
+
+	struct packed_t {
+		unsigned long long key;
+		unsigned long long id;
+	};
+
+	struct edge_t {
+		unsigned int x;
+		unsigned int y;
+		double weight;
+	};
+
+	/*Proteins added by the base graph or by a segment, and the tables to look them up*/
+	struct lookup_t {
+		unsigned long long first_id;
+		unsigned long long proteins;
+		unsigned long long packed_proteins;
+		unsigned long long names;
+		const unsigned long long *keys;
+		const packed_t *packed;
+		const unsigned long long *name_offsets;
+		const unsigned long long *name_ids;
+		const unsigned long long *name_order;
+		const char *names_text;
+	};
+
+	/*Orders edges by their larger id, then by their smaller one*/
+	static bool edge_order(const edge_t &a, const edge_t &b) {return a.x < b.x || (a.x == b.x && a.y < b.y);}
+
+	/*Lookup sections of the proteins of a graph or segment being written*/
+	struct lookup_tables_t {
+		std::vector<packed_t> packed;
+		std::vector<unsigned long long> name_offsets;
+		std::vector<unsigned long long> name_ids;
+		std::vector<unsigned long long> name_order;
+		std::vector<std::string> name_list;
+	};
+
+	const char *data;  //the whole file, mapped
+	size_t size;
+	const header_t *header;
+	const unsigned long long *offsets;
+	const unsigned int *neighbors;
+	const double *weights;
+	std::vector<lookup_t> lookups;  //of the base graph, followed by the ones of the segments
+	unsigned long long proteins;    //of the base graph and the segments
+	double max;
+
+	//Adjacency lists of the proteins with edges in the segments, merged with their lists in the base graph
+	std::vector<int> overlay_slots;  //position of the list of each protein, -1 if it is the one in the base graph
+	std::vector<unsigned long long> overlay_offsets;
+	std::vector<unsigned int> overlay_neighbors;
+	std::vector<double> overlay_weights;
+
+	/*Returns the name with the given index in a lookup*/
+	std::string get_name(const lookup_t &lookup, unsigned long long index) const;
+
+	/*Returns the position of the adjacency list of a protein in the overlay, or -1 if it is in the base graph*/
+	int overlay_slot(long id) const {return overlay_slots.empty() ? -1 : overlay_slots[id];}
+
+	/*Reads the lookup sections of a base graph or segment, from section on, and returns their end*/
+	const char *read_lookup(lookup_t &lookup, const char *section, unsigned long long name_bytes);
+
+	/*Merges the edges of the segments into the overlay*/
+	void merge_segments(const std::vector<const edge_t *> &edges, const std::vector<unsigned long long> &edge_counts);
+
+	/*Receives the keys of the proteins written, encoded by codec, and the id of the first one.
+	 *Returns their lookup sections*/
+	static lookup_tables_t build_lookup(const std::vector<unsigned long long> &keys, const AccessionCodec &codec,
+	                                    unsigned long long first_id);
+
+	/*Writes the lookup sections (after the keys and similarities)*/
+	static void write_lookup(std::ofstream &out, const lookup_tables_t &tables);
+
+	/*Writes a graph with the given keys (encoded by codec) and adjacency lists, sorted by id*/
+	static void write_graph(const std::string &graph_filename, const std::vector<unsigned long long> &keys,
+	                        const AccessionCodec &codec, const std::vector<unsigned long long> &offsets,
+	                        const std::vector<unsigned int> &neighbors, const std::vector<double> &weights,
+	                        double max_similarity);
+
+	public:
+
+		CompiledGraph();
+		~CompiledGraph();
+		CompiledGraph(const CompiledGraph &) = delete;
+		CompiledGraph &operator=(const CompiledGraph &) = delete;
+
+		/*Receives a similarities file in the format "prot1 prot2 sim" in every line.
+		 *Writes it as a compiled graph to graph_filename*/
+		static void compile(const std::string &prot_sim_filename, const std::string &graph_filename);
+
+		/*Receives a similarities file in the format "prot1 prot2 sim" and a compiled graph.
+		 *Appends a delta segment to the graph with the proteins and the similarities of the file that are new or
+		 *different in it (the first similarity of each pair in the file is kept). Returns the number of similarities
+		 *added or changed*/
+		static unsigned long long append(const std::string &prot_sim_filename, const std::string &graph_filename);
+
+		/*Rewrites a compiled graph with its segments folded into a single graph, with the same ids and similarities*/
+		static void compact(const std::string &graph_filename);
+
+		/*Returns true if the file is a compiled graph*/
+		static bool is_compiled(const std::string &filename);
+
+		/*Maps a compiled graph file into memory*/
+		void open(const std::string &graph_filename);
+
+		/*Returns the number of delta segments*/
+		int segment_count() const {return lookups.size() - 1;}
+
+		/*Returns the number of proteins*/
+		long protein_count() const {return proteins;}
+
+		/*Returns the number of similarities between pairs of proteins*/
+		long similarity_count() const;
+
+		/*Returns the largest similarity (to normalize them)*/
+		double max_similarity() const {return max;}
+
+		/*Returns the id of a protein, or -1 if it is not in the graph*/
+		long find(const std::string &pid) const;
+
+		/*Returns the name of the protein with the given id*/
+		std::string name(long id) const;
+
+		/*Returns the number of proteins similar to the protein with the given id*/
+		long degree(long id) const {
+			int slot = overlay_slot(id);
+			return slot < 0 ? offsets[id + 1] - offsets[id] : overlay_offsets[slot + 1] - overlay_offsets[slot];
+		}
+
+		/*Returns the proteins similar to the protein with the given id, in increasing order of id, and the
+		 *similarities (at the same positions)*/
+		const unsigned int *neighbors_of(long id) const {
+			int slot = overlay_slot(id);
+			return slot < 0 ? neighbors + offsets[id] : overlay_neighbors.data() + overlay_offsets[slot];
+		}
+		const double *weights_of(long id) const {
+			int slot = overlay_slot(id);
+			return slot < 0 ? weights + offsets[id] : overlay_weights.data() + overlay_offsets[slot];
+		}
+
+		/*Returns the similarity between two proteins, or a negative value if they are not similar*/
+		double similarity(long id1, long id2) const;
+};
+
+#endif
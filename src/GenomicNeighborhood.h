@@ -1,65 +1,45 @@
 #ifndef __GENOMIC_NEIGHBORHOOD_H__
 #define __GENOMIC_NEIGHBORHOOD_H__
 
-#include <iostream>
 #include <string>
-#include <vector>
-#include <algorithm>
-#include <sstream>
-
-typedef struct {
-	std::string locus;
-	std::string pid;
-	int cds_begin;
-	int cds_end;
-} protein_info_t;
-
+#include "NeighborhoodStore.h"
 
+/*One of the genomic neighborhoods of a NeighborhoodStore (restricted to its window, if any). Only refers to the
+ *store, so it is cheap to create and copy, and is valid while the store is*/
 class GenomicNeighborhood {
 
 	private:
-		std::string accession;
-		std::vector<protein_info_t> seeds;
-		std::vector<protein_info_t> proteins;
-
-		/*Receives the cds string in a format like "534..345" and splits it in the two composing numbers*/
-		/*Returns a vector with two positions.*/
-		std::vector<int> parse_cds(const std::string cds);
-
+		const NeighborhoodStore *store;
+		unsigned int n; //index of the neighborhood in the store
 
 	public:
-		typedef std::vector<protein_info_t>::iterator iterator;
-
-		GenomicNeighborhood (const std::string &acession_code);
 
-		/*Receives the locus, pid and cds of an anchor/seed protein and adds that info to the object*/
-		void add_seed(const std::string &locus, const std::string &pid, const std::string &cds);
-
-		/*Receives the locus, pid and cds of a protein and adds the protein to the object*/
-		void add_protein(const std::string &locus, const std::string &pid, const std::string &cds);
+		GenomicNeighborhood (const NeighborhoodStore &store, unsigned int n);
 
 		/*Returns genomic neighborhood accession code*/
-		std::string get_accession();
+		const std::string &get_accession() const;
+
+		/*Receives an index and appends the pid of the corresponding protein in the neighborhood sequence to a
+		 *string (e.g. an output buffer), or "." if there is no such protein*/
+		void append_pid(std::string &buffer, int index) const;
 
-		/*Returns anchor/seed proteins*/
-		std::vector<protein_info_t> get_seeds();
+		/*Receives an index and returns the pid of the corresponding protein in the neighborhood sequence*/
+		std::string get_pid(int index) const;
 
-		/*Receives an index and returns the corresponding protein in the neighborhood sequence*/
-		std::string get_pid(int index);
+		/*Returns the ProteinCollection indexes of the proteins, in order (see NeighborhoodStore::resolve)*/
+		const long *indexes() const;
 
 		/*Returns number of proteins in the genomic neighborhood*/
-		int protein_count();
+		int protein_count() const;
 
-		/*Returns the first coordinate of the genomic neighborhood*/
-		int get_first_cds();
+		/*Returns the position of the first seed among the proteins of the neighborhood, or -1 if it has no seed*/
+		int seed_index() const;
 
-		/*Returns the last coordinate of the genomic neighborhood*/
-		int get_last_cds();
+		/*Returns the first coordinate of the genomic neighborhood (the whole neighborhood, even if restricted to a window)*/
+		int get_first_cds() const;
 
-		/*Iterator for protein_info_t types, in the order that they were inserted in the object*/
-		iterator begin();
-
-		iterator end();
+		/*Returns the last coordinate of the genomic neighborhood*/
+		int get_last_cds() const;
 };
 
 #endif
@@ -1,38 +1,124 @@
 #include "HashTable.h"
 
-HashTable::HashTable(int n) {
-    table.resize(n);
-    for(int i = 0; i < n; i++){
-        table[i].resize(1);
-        table[i][0].second = -1;
-    }
-}
-
-void HashTable::insert(std::string key, int value) {
-    int index = hash_function(key)%table.size();
-    unsigned int j = 0;
-    for(; j < table[index].size(); j++){
-        if(table[index][j].first == key) return;
-        if(table[index][j].second == -1){
-            table[index][j].first = key;
-            table[index][j].second = value;
-            return;
-        }
-    }
-    table[index].resize(table.size() + 1);
-    table[index][j].first = key;
-    table[index][j].second = value;
-}
-
-int HashTable::get_value(std::string key) {
-    int index = hash_function(key)%table.size();
-    for(unsigned int j = 0; j < table[index].size(); j++){
-        if(table[index][j].first == key)
-            return table[index][j].second;
-    }
-    return -1;
-}
-
-int HashTable::get_hash(std::string key){
-    return hash_function(key)%table.size();
+/**
+ * Creates an empty table whose slots can hold n strings before the first growth
+ */
+HashTable::HashTable(size_t n)
+	: key_offsets(1, 0) {
+	size_t capacity = 16;
+	while (capacity < 2*n)
+		capacity *= 2;
+	slots.assign(capacity, slot_t {0, -1});
+}
+
+unsigned long long HashTable::hash(const char *key, size_t length) {
+	unsigned long long h = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++) {
+		h ^= (unsigned char)key[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+unsigned long long HashTable::hash(unsigned long long key) {
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+	return key ^ (key >> 31);
+}
+
+/**
+ * Probes linearly from the home slot of the hash, comparing the strings only when the stored hash is equal.
+ * @returns Slot holding the key, or the first empty slot found.
+ */
+size_t HashTable::find_slot(const char *key, size_t length, unsigned long long hash) const {
+	size_t mask = slots.size() - 1;
+	for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+		const slot_t &slot = slots[i];
+		if (slot.id < 0)
+			return i;
+		if (slot.hash == hash) {
+			size_t begin = key_offsets[slot.id];
+			if (key_offsets[slot.id + 1] - begin == length && std::memcmp(keys.data() + begin, key, length) == 0)
+				return i;
+		}
+	}
+}
+
+size_t HashTable::find_slot(unsigned long long hash) const {
+	size_t mask = slots.size() - 1;
+	for (size_t i = hash & mask; ; i = (i + 1) & mask)
+		if (slots[i].id < 0 || slots[i].hash == hash)
+			return i;
+}
+
+void HashTable::grow() {
+	std::vector<slot_t> old_slots(2*slots.size(), slot_t {0, -1});
+	old_slots.swap(slots);
+	size_t mask = slots.size() - 1;
+	for (size_t k = 0; k < old_slots.size(); k++) {
+		if (old_slots[k].id < 0) continue;
+		size_t i = old_slots[k].hash & mask;
+		while (slots[i].id >= 0)
+			i = (i + 1) & mask;
+		slots[i] = old_slots[k];
+	}
+}
+
+/**
+ * @returns Id of the key, which gets the next id (the number of strings so far) if it is new.
+ */
+int HashTable::insert(const char *key, size_t length) {
+	unsigned long long h = hash(key, length);
+	size_t i = find_slot(key, length, h);
+	if (slots[i].id >= 0)
+		return slots[i].id;
+
+	keys.insert(keys.end(), key, key + length);
+	key_offsets.push_back(keys.size());
+	return take_slot(i, h);
+}
+
+int HashTable::insert(unsigned long long key) {
+	unsigned long long h = hash(key);
+	size_t i = find_slot(h);
+	if (slots[i].id >= 0)
+		return slots[i].id;
+
+	integer_keys.push_back(key);
+	return take_slot(i, h);
+}
+
+/**
+ * Called once the key of the new id is stored.
+ * @returns The new id.
+ */
+int HashTable::take_slot(size_t i, unsigned long long hash) {
+	int id = size() - 1;
+	slots[i] = slot_t {hash, id};
+	if (2*size() > slots.size())
+		grow();
+	return id;
+}
+
+int HashTable::insert(const std::string &key) {
+	return insert(key.data(), key.size());
+}
+
+/**
+ * @returns Id of the key or -1 if it is not in the table.
+ */
+int HashTable::get_id(const char *key, size_t length) const {
+	return slots[find_slot(key, length, hash(key, length))].id;
+}
+
+int HashTable::get_id(const std::string &key) const {
+	return get_id(key.data(), key.size());
+}
+
+int HashTable::get_id(unsigned long long key) const {
+	return slots[find_slot(hash(key))].id;
+}
+
+std::string HashTable::get_key(int id) const {
+	return std::string(keys.data() + key_offsets[id], key_offsets[id + 1] - key_offsets[id]);
 }
@@ -3,14 +3,69 @@
 
 #include <string>
 #include <vector>
+#include <cstring>
 
+/*Interner of strings (e.g. protein accessions): maps each distinct string to a dense id, 0, 1, 2, ... in order of
+ *insertion. Open addressing with linear probing over a flat array of slots that store the hash of their key, so
+ *strings are only compared on equal hashes; the strings themselves are stored one after the other in a single buffer.
+ *A table can intern 64-bit integer keys (e.g. packed accessions, see AccessionCodec) instead of strings: their hash is
+ *a bijective mix of the key, so equal hashes are equal keys and nothing is compared.
+ *Lookups may run concurrently with each other, but not with inserts.*/
 class HashTable {
-    std::vector<std::vector<std::pair<std::string,int> > > table;
-    std::hash<std::string> hash_function;
-    public:
-        HashTable(int n);
-        void insert(std::string key, int value);
-        int get_value(std::string key);
-        int get_hash(std::string key);
+
+	struct slot_t {
+		unsigned long long hash;
+		int id;                  //-1 for empty slots
+	};
+
+	std::vector<slot_t> slots;       //power of two size, at most half full
+	std::vector<char> keys;          //the strings of every id, one after the other
+	std::vector<size_t> key_offsets; //start of the string of each id in keys, followed by the end of the last one
+	std::vector<unsigned long long> integer_keys; //integer key of each id, for tables of integer keys
+
+	/*Returns the slot with the given key or, if absent, the empty slot where it would be inserted*/
+	size_t find_slot(const char *key, size_t length, unsigned long long hash) const;
+
+	/*Same as above for integer keys, found by their (unique) hash alone*/
+	size_t find_slot(unsigned long long hash) const;
+
+	/*Takes the empty slot i for the next id, growing the table if it gets more than half full*/
+	int take_slot(size_t i, unsigned long long hash);
+
+	/*Doubles the number of slots, reinserting the ids from their stored hashes*/
+	void grow();
+
+	public:
+
+		/*Creates an empty table with room for n strings before growing*/
+		HashTable(size_t n = 0);
+
+		/*Returns the id of key, inserting it with the next id if it is new*/
+		int insert(const std::string &key);
+		int insert(const char *key, size_t length);
+
+		/*Returns the id of an integer key, inserting it with the next id if it is new*/
+		int insert(unsigned long long key);
+
+		/*Returns the id of key, or -1 if it was never inserted*/
+		int get_id(const std::string &key) const;
+		int get_id(const char *key, size_t length) const;
+		int get_id(unsigned long long key) const;
+
+		/*Returns the string with the given id*/
+		std::string get_key(int id) const;
+
+		/*Returns the integer key with the given id*/
+		unsigned long long get_integer_key(int id) const {return integer_keys[id];}
+
+		/*Returns the number of distinct keys inserted*/
+		size_t size() const {return key_offsets.size() - 1 + integer_keys.size();}
+
+		/*64-bit FNV-1a hash of a string*/
+		static unsigned long long hash(const char *key, size_t length);
+
+		/*Bijective 64-bit mix of an integer key (the splitmix64 finalizer)*/
+		static unsigned long long hash(unsigned long long key);
 };
+
 #endif
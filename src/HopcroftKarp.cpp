@@ -0,0 +1,88 @@
+#include "HopcroftKarp.h"
+
+static const int INF = std::numeric_limits<int>::max();
+
+/**
+ * Creates a graph with n_left and n_right vertices on each side and no edges
+ */
+HopcroftKarp::HopcroftKarp(int n_left, int n_right)
+	: n_left(n_left), n_right(n_right), adj(n_left), left_match(n_left, -1), right_match(n_right, -1),
+	  dist(n_left) {
+}
+
+/**
+ * Adds an edge between left vertex u and right vertex v
+ */
+void HopcroftKarp::add_edge(int u, int v) {
+	adj[u].push_back(v);
+}
+
+/**
+ * Builds the BFS layers starting from the free left vertices.
+ * @returns True if some free right vertex can be reached (there is an augmenting path).
+ */
+bool HopcroftKarp::bfs() {
+	std::queue<int, std::deque<int, ArenaAllocator<int> > > my_queue;
+	bool found = false;
+
+	for (int u = 0; u < n_left; u++) {
+		if (left_match[u] < 0) {
+			dist[u] = 0;
+			my_queue.push(u);
+		}
+		else
+			dist[u] = INF;
+	}
+
+	while (!my_queue.empty()) {
+		int u = my_queue.front();
+		my_queue.pop();
+		for (unsigned int k = 0; k < adj[u].size(); k++) {
+			int w = right_match[adj[u][k]];
+			if (w < 0)
+				found = true;
+			else if (dist[w] == INF) {
+				dist[w] = dist[u] + 1;
+				my_queue.push(w);
+			}
+		}
+	}
+	return found;
+}
+
+/**
+ * Looks for an augmenting path from left vertex u following the BFS layers and flips it if found.
+ */
+bool HopcroftKarp::dfs(int u) {
+	for (unsigned int k = 0; k < adj[u].size(); k++) {
+		int v = adj[u][k];
+		int w = right_match[v];
+		if (w < 0 || (dist[w] == dist[u] + 1 && dfs(w))) {
+			left_match[u] = v;
+			right_match[v] = u;
+			return true;
+		}
+	}
+	dist[u] = INF; //dead end, not visited again in this phase
+	return false;
+}
+
+/**
+ * Computes a maximum matching.
+ * @returns Number of matched pairs.
+ */
+int HopcroftKarp::solve() {
+	int matching = 0;
+	while (bfs())
+		for (int u = 0; u < n_left; u++)
+			if (left_match[u] < 0 && dfs(u))
+				matching++;
+	return matching;
+}
+
+/**
+ * @returns The right vertex matched to each left vertex (-1 if unmatched).
+ */
+const arena_vector<int>& HopcroftKarp::get_matching() const {
+	return left_match;
+}
@@ -0,0 +1,41 @@
+#ifndef __HOPCROFT_KARP_H__
+#define __HOPCROFT_KARP_H__
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include "Arena.h"
+
+/*Maximum cardinality matching of an unweighted bipartite graph with the Hopcroft-Karp algorithm, in O(E*sqrt(V))*/
+class HopcroftKarp {
+
+	private:
+		int n_left;
+		int n_right;
+		arena_vector<arena_vector<int> > adj; //adjacency lists of the left vertices
+		arena_vector<int> left_match;         //right vertex matched to each left vertex, -1 if unmatched
+		arena_vector<int> right_match;        //left vertex matched to each right vertex, -1 if unmatched
+		arena_vector<int> dist;               //BFS layer of each left vertex
+
+		/*Builds the BFS layers from the free left vertices. Returns true if some free right vertex is reachable*/
+		bool bfs();
+
+		/*Looks for an augmenting path from left vertex u along the BFS layers*/
+		bool dfs(int u);
+
+	public:
+
+		/*Creates a graph with n_left and n_right vertices on each side and no edges*/
+		HopcroftKarp(int n_left, int n_right);
+
+		/*Adds an edge between left vertex u and right vertex v*/
+		void add_edge(int u, int v);
+
+		/*Computes a maximum matching and returns its size*/
+		int solve();
+
+		/*Returns the right vertex matched to each left vertex (-1 if unmatched)*/
+		const arena_vector<int>& get_matching() const;
+};
+
+#endif
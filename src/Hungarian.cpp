@@ -31,12 +31,17 @@ Hungarian::Hungarian()
 	m_rows = 1;
 	m_cols = 1;
 	m_cost = 0;
-	m_costmatrix_aux.resize(m_rows, vector<int>(m_cols,0));
-	m_costmatrix.resize(m_rows, vector<int>(m_cols,0));
-	m_assignment.resize(m_rows, vector<int>(m_cols,0));
+	m_max_cost = 0;
+	m_mode = HUNGARIAN_MODE_MINIMIZE_COST;
+	m_has_cutoff = false;
+	m_cutoff = 0;
+	m_below_cutoff = false;
+	m_costmatrix_aux.resize(m_rows, arena_vector<int>(m_cols,0));
+	m_costmatrix.resize(m_rows, arena_vector<int>(m_cols,0));
+	m_assignment.resize(m_rows, arena_vector<int>(m_cols,0));
 }
 
-Hungarian::Hungarian(const vector<vector<int> >& input_matrix, int rows, int cols, MODE mode)
+Hungarian::Hungarian(const hungarian_matrix_t& input_matrix, int rows, int cols, MODE mode)
 {
   int i,j, org_cols, org_rows;
   int max_cost;
@@ -57,9 +62,9 @@ Hungarian::Hungarian(const vector<vector<int> >& input_matrix, int rows, int col
   m_rows = rows;
   m_cols = cols;
 
-  m_costmatrix_aux.resize(rows, vector<int>(cols,0));
-  m_costmatrix.resize(rows, vector<int>(cols,0));
-  m_assignment.resize(rows, vector<int>(cols,0));
+  m_costmatrix_aux.resize(rows, arena_vector<int>(cols,0));
+  m_costmatrix.resize(rows, arena_vector<int>(cols,0));
+  m_assignment.resize(rows, arena_vector<int>(cols,0));
 
   for(i=0; i<m_rows; i++)
   {
@@ -77,6 +82,12 @@ Hungarian::Hungarian(const vector<vector<int> >& input_matrix, int rows, int col
   }
 
 
+  m_max_cost = max_cost;
+  m_mode = mode;
+  m_has_cutoff = false;
+  m_cutoff = 0;
+  m_below_cutoff = false;
+
   if (mode == HUNGARIAN_MODE_MAXIMIZE_UTIL)
   {
 	  for(i=0; i<m_rows; i++)
@@ -95,8 +106,8 @@ Hungarian::Hungarian(const vector<vector<int> >& input_matrix, int rows, int col
     fprintf(stderr,"%s: unknown mode. Mode was set to HUNGARIAN_MODE_MINIMIZE_COST !\n", __FUNCTION__);
 }
 
-std::map<std::pair<int, int>,int> Hungarian::get_assignments() {
-	std::map<std::pair<int, int>,int> assignment;
+assignments_t Hungarian::get_assignments() {
+	assignments_t assignment;
 	for (int i = 0; i < m_rows; i++)
 		for (int j = 0; j < m_cols; j++)
 			if (m_assignment[i][j])
@@ -104,7 +115,7 @@ std::map<std::pair<int, int>,int> Hungarian::get_assignments() {
 	return assignment;
 }
 
-void hungarian_print_matrix(const vector<vector<int> >& C, int rows, int cols)
+void hungarian_print_matrix(const hungarian_matrix_t& C, int rows, int cols)
 {
 	int i,j;
 	fprintf(stderr , "\n");
@@ -139,7 +150,7 @@ void Hungarian::print_status()
 
 }
 
-int Hungarian::init(const vector<vector<int> >& input_matrix, int rows, int cols, MODE mode)
+int Hungarian::init(const hungarian_matrix_t& input_matrix, int rows, int cols, MODE mode)
 {
 
   int i,j, org_cols, org_rows;
@@ -157,9 +168,9 @@ int Hungarian::init(const vector<vector<int> >& input_matrix, int rows, int cols
   m_rows = rows;
   m_cols = cols;
 
-  m_costmatrix_aux.resize(rows, vector<int>(cols,0));
-  m_costmatrix.resize(rows, vector<int>(cols,0));
-  m_assignment.resize(rows, vector<int>(cols,0));
+  m_costmatrix_aux.resize(rows, arena_vector<int>(cols,0));
+  m_costmatrix.resize(rows, arena_vector<int>(cols,0));
+  m_assignment.resize(rows, arena_vector<int>(cols,0));
 
   for(i=0; i<m_rows; i++)
   {
@@ -175,6 +186,10 @@ int Hungarian::init(const vector<vector<int> >& input_matrix, int rows, int cols
   }
 
 
+  m_max_cost = max_cost;
+  m_mode = mode;
+  m_below_cutoff = false;
+
   if (mode == HUNGARIAN_MODE_MAXIMIZE_UTIL) {
     for(i=0; i<m_rows; i++) {
       for(j=0; j<m_cols; j++) {
@@ -191,7 +206,63 @@ int Hungarian::init(const vector<vector<int> >& input_matrix, int rows, int cols
   return rows;
 }
 
-bool Hungarian::check_solution(const vector<int>& row_dec, const vector<int>& col_inc, const vector<int>& col_vertex)
+void Hungarian::set_cutoff(long long cutoff)
+{
+	m_has_cutoff = true;
+	m_cutoff = cutoff;
+}
+
+bool Hungarian::below_cutoff() const
+{
+	return m_below_cutoff;
+}
+
+void Hungarian::set_column_potentials(const std::vector<int>& potentials)
+{
+	m_warm_potentials.assign(potentials.begin(), potentials.end());
+}
+
+const arena_vector<int>& Hungarian::column_potentials() const
+{
+	return m_col_potentials;
+}
+
+bool Hungarian::cutoff_reached(const arena_vector<int>& row_dec, const arena_vector<int>& col_inc, long long col_min_sum)
+{
+	// Any dual feasible solution (the reduced matrix keeps
+	// m_costmatrix[k][l] >= row_dec[k]-col_inc[l]) bounds the optimum:
+	// every assignment costs at least col_min_sum+sum(row_dec)-sum(col_inc)
+	int k, l;
+	long long lower_bound = col_min_sum;
+
+	if (!m_has_cutoff)
+		return false;
+
+	for (k=0;k<m_rows;k++)
+		lower_bound+=row_dec[k];
+	for (l=0;l<m_cols;l++)
+		lower_bound-=col_inc[l];
+
+	if (m_mode == HUNGARIAN_MODE_MAXIMIZE_UTIL)
+		m_below_cutoff = (long long)m_rows*m_max_cost-lower_bound < m_cutoff;
+	else
+		m_below_cutoff = lower_bound > m_cutoff;
+
+	if (verbose && m_below_cutoff)
+		fprintf(stderr, "Dual bound %lld can't reach the cutoff %lld\n", lower_bound, m_cutoff);
+
+	return m_below_cutoff;
+}
+
+void Hungarian::store_potentials(const arena_vector<int>& col_inc, const arena_vector<int>& col_sub)
+{
+	// the reduced costs are m_costmatrix[k][l]-col_sub[l]-row_dec[k]+col_inc[l]
+	m_col_potentials.resize(m_cols);
+	for (int l=0;l<m_cols;l++)
+		m_col_potentials[l] = col_inc[l]-col_sub[l];
+}
+
+bool Hungarian::check_solution(const arena_vector<int>& row_dec, const arena_vector<int>& col_inc, const arena_vector<int>& col_vertex)
 {
 	int k, l, m, n;
 
@@ -227,7 +298,7 @@ bool Hungarian::check_solution(const vector<int>& row_dec, const vector<int>& co
 	return true;
   // End doublecheck the solution 23
 }
-bool Hungarian::assign_solution(const vector<int>& row_dec,const vector<int>&  col_inc, const vector<int>&  col_vertex)
+bool Hungarian::assign_solution(const arena_vector<int>& row_dec,const arena_vector<int>&  col_inc, const arena_vector<int>&  col_vertex)
 {
 	  // End Hungarian algorithm 18
 	int i, k, l, m, n;
@@ -267,6 +338,7 @@ bool Hungarian::assign_solution(const vector<int>& row_dec,const vector<int>&  c
 bool Hungarian::solve()
 {
 	int i, j, m, n, k, l, s, t, q, unmatched, cost;
+	long long col_min_sum = 0;
 
 	m = m_rows;
 	n = m_cols;
@@ -274,8 +346,8 @@ bool Hungarian::solve()
 	int INF = std::numeric_limits<int>::max();
 
 	//vertex alternating paths,
-	vector<int> col_vertex(m), row_vertex(n), unchosen_row(m), parent_row(n),
-				row_dec(m),  col_inc(n),  slack_row(m),    slack(n);
+	arena_vector<int> col_vertex(m), row_vertex(n), unchosen_row(m), parent_row(n),
+				row_dec(m),  col_inc(n),  slack_row(m),    slack(n), col_sub(n);
 
 	cost=0;
 
@@ -296,7 +368,7 @@ bool Hungarian::solve()
 	}
 
 	//Double check assignment matrix is 0
-	m_assignment.assign(m, vector<int>(n, HUNGARIAN_NOT_ASSIGNED));
+	m_assignment.assign(m, arena_vector<int>(n, HUNGARIAN_NOT_ASSIGNED));
 
   // Begin subtract column minima in order to start with lots of zeroes 12
 	if (verbose)
@@ -304,18 +376,31 @@ bool Hungarian::solve()
 		fprintf(stderr, "Using heuristic\n");
 	}
 
+	m_col_potentials.clear();
+
 	for (l=0;l<n;l++)
 	{
 		s = m_costmatrix[0][l];
 
-		for (k=1;k<m;k++)
+		// warm start: any column potential keeps the duals feasible,
+		// since the row minima below are taken after subtracting it
+		if (l < (int)m_warm_potentials.size())
 		{
-			if (m_costmatrix[k][l] < s)
+			s = -m_warm_potentials[l];
+		}
+		else
+		{
+			for (k=1;k<m;k++)
 			{
-				s=m_costmatrix[k][l];
+				if (m_costmatrix[k][l] < s)
+				{
+					s=m_costmatrix[k][l];
+				}
+				cost += s;
 			}
-			cost += s;
 		}
+		col_min_sum += s;
+		col_sub[l] = s;
 
 		if (s!=0)
 		{
@@ -341,18 +426,19 @@ bool Hungarian::solve()
 		bool row_done = false;
 		s=m_costmatrix[k][0];
 
-		for (l=0;l<n;l++)
+		// the row minimum must be known before matching, otherwise the
+		// matched column may not be tight and the solution check fails
+		for (l=1;l<n;l++)
 		{
-
-			if(l > 0)
+			if (m_costmatrix[k][l] < s)
 			{
-				if (m_costmatrix[k][l] < s)
-				{
-					s = m_costmatrix[k][l];
-				}
-				row_dec[k]=s;
+				s = m_costmatrix[k][l];
 			}
+		}
+		row_dec[k]=s;
 
+		for (l=0;l<n;l++)
+		{
 			if (s == m_costmatrix[k][l] && row_vertex[l]<0)
 				{
 					col_vertex[k]=l;
@@ -382,6 +468,12 @@ bool Hungarian::solve()
 	}
   // End initial state 16
 
+	//stop if the initial duals already prove the cutoff can't be reached
+	if (cutoff_reached(row_dec, col_inc, col_min_sum))
+	{
+		return false;
+	}
+
 	bool checked = false;
 
   // Begin Hungarian algorithm 18
@@ -394,6 +486,7 @@ bool Hungarian::solve()
 		{
 			//finish assignment, wrap up and done.
 			bool assign = assign_solution(row_dec, col_inc, col_vertex);
+			store_potentials(col_inc, col_sub);
 			return true;
 		}
 		else
@@ -513,6 +606,12 @@ bool Hungarian::solve()
 				col_inc[l]+=s;
 			}
 		}
+
+		//stop if the new duals prove the cutoff can't be reached
+		if (cutoff_reached(row_dec, col_inc, col_min_sum))
+		{
+			return false;
+		}
 	// End introduce a new zero into the matrix 21
 	}
 
@@ -546,6 +645,7 @@ bool Hungarian::solve()
 			{
 				//finish assignment, wrap up and done.
 				bool assign = assign_solution(row_dec, col_inc, col_vertex);
+				store_potentials(col_inc, col_sub);
 				return true;
 			}
 			else
@@ -587,7 +687,7 @@ int Hungarian::cost() const
 	return m_cost;
 }
 
-const vector<vector<int> >& Hungarian::assignment() const
+const hungarian_matrix_t& Hungarian::assignment() const
 {
 	return m_assignment;
 }
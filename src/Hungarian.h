@@ -24,12 +24,17 @@
 #include <limits>
 #include <vector>
 #include <map>
+#include "Arena.h"
 
 #ifndef HUNGARIAN_H
 #define HUNGARIAN_H
 
 using std::vector;
 
+/* Square cost matrices and the solver workspace live in the arena of
+ * the calling thread, if it has one (see Arena.h). */
+typedef arena_vector<arena_vector<int> > hungarian_matrix_t;
+
 typedef enum {
 	HUNGARIAN_MODE_MINIMIZE_COST,
 	HUNGARIAN_MODE_MAXIMIZE_UTIL,
@@ -50,9 +55,9 @@ public:
 	 *  It returns the size of the quadratic(!) assignment matrix. **/
 
 	Hungarian();
-	Hungarian(const vector<vector<int> >&, int, int, MODE);
+	Hungarian(const hungarian_matrix_t&, int, int, MODE);
 
-	int init(const vector<vector<int> >& input_matrix,
+	int init(const hungarian_matrix_t& input_matrix,
 			   int rows,
 			   int cols,
 			   MODE mode);
@@ -60,14 +65,32 @@ public:
 	/** This method computes the optimal assignment. **/
 	bool solve();
 
+	/** Makes solve() stop early, returning false, as soon as the dual
+	 *  bound proves that the optimum can't reach the cutoff (a utility
+	 *  below it when maximizing, a cost above it when minimizing). **/
+	void set_cutoff(long long cutoff);
+
+	/** True if the last solve() stopped because of the cutoff **/
+	bool below_cutoff() const;
+
+	/** Starts the next solve() from the given column potentials (the
+	 *  column_potentials() of a solve on a similar matrix, e.g. one
+	 *  sharing its columns). Columns without one start as usual. **/
+	void set_column_potentials(const std::vector<int>& potentials);
+
+	/** Column duals of the last complete solve(), negated. When
+	 *  maximizing they don't depend on the largest utility, so they
+	 *  can warm start matrices with different values. **/
+	const arena_vector<int>& column_potentials() const;
+
 	/** Accessor for the cost **/
 	int cost() const;
 
 	/** Reference accessor for assignment **/
-	const vector<vector<int> >& assignment() const;
+	const hungarian_matrix_t& assignment() const;
 
 	/** Returns matriz with the assignments **/
-	std::map<std::pair<int, int>,int> get_assignments();
+	assignments_t get_assignments();
 
 	/** Print the computed optimal assignment. **/
 	void print_assignment();
@@ -79,17 +102,26 @@ public:
 	void print_status();
 
 protected:
-	bool check_solution(const vector<int>& row_dec, const vector<int>& col_inc, const vector<int>& col_vertex);
-	bool assign_solution(const vector<int>& row_dec, const vector<int>& col_inc, const vector<int>& col_vertex);
+	bool check_solution(const arena_vector<int>& row_dec, const arena_vector<int>& col_inc, const arena_vector<int>& col_vertex);
+	bool assign_solution(const arena_vector<int>& row_dec, const arena_vector<int>& col_inc, const arena_vector<int>& col_vertex);
+	bool cutoff_reached(const arena_vector<int>& row_dec, const arena_vector<int>& col_inc, long long col_min_sum);
+	void store_potentials(const arena_vector<int>& col_inc, const arena_vector<int>& col_sub);
 
 private:
 
 	int m_cost;
+	int m_max_cost; /*largest input value, used to turn utilities into costs when maximizing*/
+	MODE m_mode;
+	bool m_has_cutoff;
+	long long m_cutoff;
+	bool m_below_cutoff;
+	arena_vector<int> m_warm_potentials;
+	arena_vector<int> m_col_potentials;
 	int m_rows;
 	int m_cols;
-	vector<vector<int> > m_costmatrix_aux; /*Igor: cost matrix as received by the input. Not modified throughout the execution (that is not true for m_costmatrix)*/
-	vector<vector<int> > m_costmatrix;
-	vector<vector<int> > m_assignment;
+	hungarian_matrix_t m_costmatrix_aux; /*Igor: cost matrix as received by the input. Not modified throughout the execution (that is not true for m_costmatrix)*/
+	hungarian_matrix_t m_costmatrix;
+	hungarian_matrix_t m_assignment;
 
 };
 
@@ -0,0 +1,169 @@
+#include "NeighborhoodIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ *Writes a section of the file, padded to 8 bytes
+ */
+static void write_section(std::ofstream &file, const void *section, size_t bytes) {
+	static const char padding[8] = {0};
+	file.write((const char *)section, bytes);
+	file.write(padding, (8 - bytes % 8) % 8);
+}
+
+static size_t padded(size_t bytes) {return (bytes + 7)/8*8;}
+
+NeighborhoodIndex::NeighborhoodIndex()
+	: data(NULL), file_size(0), header(NULL) {
+}
+
+NeighborhoodIndex::~NeighborhoodIndex() {
+	if (data)
+		munmap((void *)data, file_size);
+}
+
+/**
+ *Reads the proteins of the neighborhoods by their graph id and writes them with the postings of each graph protein
+ *(see the file layout in NeighborhoodIndex.h)
+ */
+void NeighborhoodIndex::build(NeighborhoodStore &neighborhoods, const CompiledGraph &graph,
+                              const std::string &index_filename) {
+	neighborhoods.resolve(graph, 0, neighborhoods.size());
+
+	header_t header;
+	memcpy(header.magic, "NCINDEX1", 8);
+	header.neighborhoods = neighborhoods.size();
+	header.graph_proteins = graph.protein_count();
+	header.graph_similarities = graph.similarity_count();
+
+	std::vector<unsigned long long> offsets(1, 0), seed_offsets(1, 0), accession_offsets(1, 0);
+	std::vector<int> ids, cds_begins, cds_ends;
+	std::vector<unsigned int> seeds;
+	std::string accessions;
+	std::vector<unsigned long long> posting_offsets(graph.protein_count() + 1, 0);
+	for (unsigned int n = 0; n < neighborhoods.size(); n++) {
+		const long *indexes = neighborhoods.protein_indexes(n);
+		unsigned int first = neighborhoods.first_protein(n);
+		for (int i = 0; i < neighborhoods.protein_count(n); i++) {
+			ids.push_back(indexes[i]);
+			cds_begins.push_back(neighborhoods.cds_begin(first + i));
+			cds_ends.push_back(neighborhoods.cds_end(first + i));
+		}
+		for (int s = 0; s < neighborhoods.seed_count(n); s++)
+			seeds.push_back(neighborhoods.seed_positions(n)[s] - first);
+		offsets.push_back(ids.size());
+		seed_offsets.push_back(seeds.size());
+		accessions += neighborhoods.get_accession(n);
+		accession_offsets.push_back(accessions.size());
+
+		//Each neighborhood is posted once under each of its proteins
+		std::vector<long> distinct(indexes, indexes + neighborhoods.protein_count(n));
+		std::sort(distinct.begin(), distinct.end());
+		distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+		for (unsigned int i = 0; i < distinct.size(); i++)
+			if (distinct[i] >= 0)
+				posting_offsets[distinct[i] + 1]++;
+	}
+	for (long id = 0; id < graph.protein_count(); id++)
+		posting_offsets[id + 1] += posting_offsets[id];
+
+	std::vector<unsigned int> postings(posting_offsets.back());
+	std::vector<unsigned long long> next(posting_offsets.begin(), posting_offsets.end() - 1);
+	for (unsigned int n = 0; n < neighborhoods.size(); n++)
+		for (unsigned long long p = offsets[n]; p < offsets[n + 1]; p++)
+			if (ids[p] >= 0 && (next[ids[p]] == posting_offsets[ids[p]] || postings[next[ids[p]] - 1] != n))
+				postings[next[ids[p]]++] = n;
+
+	header.proteins = ids.size();
+	header.seeds = seeds.size();
+	header.accession_bytes = accessions.size();
+	header.postings = postings.size();
+
+	std::ofstream out(index_filename.c_str(), std::ios::binary);
+	if (out.fail()) {
+		std::cerr << "ERROR: trouble writing the neighborhood index file\n";
+		exit(1);
+	}
+	write_section(out, &header, sizeof(header));
+	write_section(out, offsets.data(), offsets.size()*sizeof(unsigned long long));
+	write_section(out, seed_offsets.data(), seed_offsets.size()*sizeof(unsigned long long));
+	write_section(out, ids.data(), ids.size()*sizeof(int));
+	write_section(out, cds_begins.data(), cds_begins.size()*sizeof(int));
+	write_section(out, cds_ends.data(), cds_ends.size()*sizeof(int));
+	write_section(out, seeds.data(), seeds.size()*sizeof(unsigned int));
+	write_section(out, accession_offsets.data(), accession_offsets.size()*sizeof(unsigned long long));
+	write_section(out, accessions.data(), accessions.size());
+	write_section(out, posting_offsets.data(), posting_offsets.size()*sizeof(unsigned long long));
+	write_section(out, postings.data(), postings.size()*sizeof(unsigned int));
+}
+
+/**
+ *Maps the file and finds its sections (see the file layout in NeighborhoodIndex.h)
+ */
+void NeighborhoodIndex::open(const std::string &index_filename, const CompiledGraph &graph) {
+	int fd = ::open(index_filename.c_str(), O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) < 0) {
+		std::cerr << "ERROR: trouble opening the neighborhood index file\n";
+		exit(1);
+	}
+	file_size = info.st_size;
+	void *mapped = file_size >= sizeof(header_t) ? mmap(NULL, file_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+	::close(fd);
+	if (mapped == MAP_FAILED || memcmp(mapped, "NCINDEX1", 8) != 0) {
+		std::cerr << "ERROR: " << index_filename << " is not a neighborhood index file\n";
+		exit(1);
+	}
+	data = (const char *)mapped;
+
+	const char *section = data;
+	header = (const header_t *)section;
+	section += padded(sizeof(header_t));
+	offsets = (const unsigned long long *)section;
+	section += padded((header->neighborhoods + 1)*sizeof(unsigned long long));
+	seed_offsets = (const unsigned long long *)section;
+	section += padded((header->neighborhoods + 1)*sizeof(unsigned long long));
+	ids = (const int *)section;
+	section += padded(header->proteins*sizeof(int));
+	cds_begins = (const int *)section;
+	section += padded(header->proteins*sizeof(int));
+	cds_ends = (const int *)section;
+	section += padded(header->proteins*sizeof(int));
+	seeds = (const unsigned int *)section;
+	section += padded(header->seeds*sizeof(unsigned int));
+	accession_offsets = (const unsigned long long *)section;
+	section += padded((header->neighborhoods + 1)*sizeof(unsigned long long));
+	accessions = section;
+	section += padded(header->accession_bytes);
+	posting_offsets = (const unsigned long long *)section;
+	section += padded((header->graph_proteins + 1)*sizeof(unsigned long long));
+	postings_data = (const unsigned int *)section;
+	section += padded(header->postings*sizeof(unsigned int));
+	if (section > data + file_size) {
+		std::cerr << "ERROR: " << index_filename << " is truncated\n";
+		exit(1);
+	}
+
+	if (header->graph_proteins != (unsigned long long)graph.protein_count() ||
+	    header->graph_similarities != (unsigned long long)graph.similarity_count()) {
+		std::cerr << "ERROR: " << index_filename << " was not built from this compiled graph\n";
+		exit(1);
+	}
+}
+
+void NeighborhoodIndex::add_to(NeighborhoodStore &neighborhoods, unsigned int n, const CompiledGraph &graph) const {
+	char cds[32];
+	neighborhoods.add_neighborhood(std::string(accessions + accession_offsets[n], accessions + accession_offsets[n + 1]));
+	unsigned long long s = seed_offsets[n];
+	for (unsigned long long p = offsets[n]; p < offsets[n + 1]; p++) {
+		snprintf(cds, sizeof(cds), "%d..%d", cds_begins[p], cds_ends[p]);
+		neighborhoods.add_protein(ids[p] >= 0 ? graph.name(ids[p]) : ".", cds);
+		for (; s < seed_offsets[n + 1] && seeds[s] == p - offsets[n]; s++)
+			neighborhoods.add_seed();
+	}
+}
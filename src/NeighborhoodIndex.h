@@ -0,0 +1,85 @@
+#ifndef __NEIGHBORHOOD_INDEX_H__
+#define __NEIGHBORHOOD_INDEX_H__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "NeighborhoodStore.h"
+#include "CompiledGraph.h"
+
+/*Genomic neighborhoods indexed by the proteins of a compiled graph, written to a binary file that is mapped into
+ *memory when opened: a query only reads the neighborhoods with a protein similar to one of its own (see postings) and
+ *their proteins. The neighborhoods are numbered in their order in the neighborhoods file, and their proteins are kept
+ *by their graph id, so the index is used with the graph it was built from.
+ *
+ *File layout, 8-byte aligned sections one after the other:
+ *  header            magic "NCINDEX1", then the counts below and the graph they refer to (see header_t)
+ *  offsets[neighborhoods + 1]       first protein of each neighborhood, followed by the end of the last one
+ *  seed_offsets[neighborhoods + 1]  first seed of each neighborhood, followed by the end of the last one
+ *  ids[proteins]                    graph id of each protein, -1 if it is not in the graph (32 bits)
+ *  cds_begins[proteins], cds_ends[proteins]   coordinates of each protein (32 bits)
+ *  seeds[seeds]                     position of each seed among the proteins of its neighborhood (32 bits)
+ *  accession_offsets[neighborhoods + 1], then the accessions
+ *  posting_offsets[graph proteins + 1]   start of the postings of each graph protein (CSR)
+ *  postings[postings]               the neighborhoods with each protein, in increasing order (32 bits)*/
+class NeighborhoodIndex {
+
+	struct header_t {
+		char magic[8];
+		unsigned long long neighborhoods;
+		unsigned long long proteins;
+		unsigned long long seeds;
+		unsigned long long accession_bytes;
+		unsigned long long postings;
+		unsigned long long graph_proteins;     //of the graph the index was built from...
+		unsigned long long graph_similarities; //...to check that it is the one given with it
+	};
+
+	const char *data;  //the whole file, mapped
+	size_t file_size;
+	const header_t *header;
+	const unsigned long long *offsets;
+	const unsigned long long *seed_offsets;
+	const int *ids;
+	const int *cds_begins;
+	const int *cds_ends;
+	const unsigned int *seeds;
+	const unsigned long long *accession_offsets;
+	const char *accessions;
+	const unsigned long long *posting_offsets;
+	const unsigned int *postings_data;
+
+	public:
+
+		NeighborhoodIndex();
+		~NeighborhoodIndex();
+		NeighborhoodIndex(const NeighborhoodIndex &) = delete;
+		NeighborhoodIndex &operator=(const NeighborhoodIndex &) = delete;
+
+		/*Receives a store of genomic neighborhoods (whole, not restricted to windows) and the compiled graph of
+		 *their protein similarities.
+		 *Writes the index of the neighborhoods to index_filename*/
+		static void build(NeighborhoodStore &neighborhoods, const CompiledGraph &graph, const std::string &index_filename);
+
+		/*Maps an index file into memory, checking that it was built from the graph*/
+		void open(const std::string &index_filename, const CompiledGraph &graph);
+
+		/*Returns the number of neighborhoods*/
+		unsigned int size() const {return header->neighborhoods;}
+
+		/*Returns the number of proteins of neighborhood n*/
+		int protein_count(unsigned int n) const {return offsets[n + 1] - offsets[n];}
+
+		/*Returns the number of neighborhoods with the protein with the given graph id, and the neighborhoods
+		 *themselves, in increasing order*/
+		unsigned long long posting_count(long id) const {return posting_offsets[id + 1] - posting_offsets[id];}
+		const unsigned int *postings(long id) const {return postings_data + posting_offsets[id];}
+
+		/*Adds neighborhood n to a store of genomic neighborhoods, its proteins named as in the graph ("." if they
+		 *are not in it)*/
+		void add_to(NeighborhoodStore &neighborhoods, unsigned int n, const CompiledGraph &graph) const;
+};
+
+#endif
@@ -0,0 +1,199 @@
+#include "NeighborhoodStore.h"
+
+/**
+ *Receives a string and delimiters.
+ *Splits the string in a vector according to delimiters
+ */
+static std::vector<std::string> split(const std::string& in, const std::string& delim) {
+	std::string::size_type start = in.find_first_not_of(delim), end = 0;
+
+	std::vector<std::string> out;
+	while(start != in.npos) {
+		end = in.find_first_of(delim, start);
+		if(end == in.npos) {
+			out.push_back(in.substr(start));
+			break;
+		} else {
+			out.push_back(in.substr(start, end-start));
+		}
+		start = in.find_first_not_of(delim, end);
+	}
+	return out;
+}
+
+/**
+ *Receives the fields of a line of the neighborhoods file.
+ *Returns true if it is the line of a protein (seeds included)
+ */
+static bool is_protein_line(const std::vector<std::string> &split_line) {
+	if (split_line.size() < 2) return false;
+	return (split_line[0] == "." && split_line[1] != "cds") || split_line[0] == "-->";
+}
+
+NeighborhoodStore::NeighborhoodStore() {
+	offsets.push_back(0);
+	seed_offsets.push_back(0);
+}
+
+void NeighborhoodStore::load(const std::string &neighborhoods_filename) {
+	/*Receives a genomic neighborhood filename and adds its neighborhoods to the store*/
+	std::ifstream file;
+	std::string line;
+	long long position = 0; //of the line in the file
+
+	file.open(neighborhoods_filename.c_str());
+	if (file.fail()) {
+		std::cerr << "ERROR: trouble opening the neighborhoods file\n";
+		exit(1);
+	}
+	filenames.push_back(neighborhoods_filename);
+
+	for (; std::getline(file, line); position += line.size() + 1)
+		add_line(line, position);
+	file.close();
+}
+
+bool NeighborhoodStore::add_line(const std::string &line, long long file_offset) {
+	/*Receives a line of a genomic neighborhoods file and adds what it has to the store*/
+	std::vector<std::string> split_line = split(line, " \t");
+	if (split_line.empty()) return false;
+
+	if (split_line[0] == "ORGANISM") { //beginning of organism
+		for (unsigned int accession_index = 0; accession_index < split_line.size(); accession_index++) { //find index of accession code
+			if (split_line[accession_index] == "accession") {
+				add_neighborhood(split_line[accession_index + 3], file_offset);
+				return true;
+			}
+		}
+	}
+	else if (is_protein_line(split_line) && size() > 0) {
+		add_protein(split_line[4], split_line[1]); //pid cds
+		if (split_line[0] == "-->") //seed protein
+			add_seed();
+	}
+	return false;
+}
+
+void NeighborhoodStore::add_neighborhood(const std::string &accession, long long file_offset) {
+	/*Starts a new neighborhood with the given accession code*/
+	int id = accession_ids.insert(accession);
+	if (id == (int)accession_names.size())
+		accession_names.push_back(accession);
+
+	accessions.push_back(id);
+	offsets.push_back(pids.size());
+	window_begins.push_back(pids.size());
+	window_ends.push_back(pids.size());
+	seed_offsets.push_back(seeds.size());
+	file_offsets.push_back(file_offset);
+	file_ids.push_back((int)filenames.size() - 1);
+}
+
+void NeighborhoodStore::add_protein(const std::string &pid, const std::string &cds) {
+	/*Receives the pid and cds of a protein and adds it to the last neighborhood. The cds is in a format like
+	 *"534..345"*/
+	const char *text = cds.c_str();
+	char *end;
+	int begin = strtol(text, &end, 10);
+	while (*end == '.') end++;
+
+	pids.push_back(codec.encode(pid));
+	cds_begins.push_back(begin);
+	cds_ends.push_back(strtol(end, NULL, 10));
+	offsets.back() = pids.size();
+	window_ends.back() = pids.size();
+}
+
+void NeighborhoodStore::add_seed() {
+	/*Makes the last protein added a seed of its neighborhood*/
+	seeds.push_back(pids.size() - 1);
+	seed_offsets.back() = seeds.size();
+}
+
+void NeighborhoodStore::resolve(ProteinCollection &clusters) {
+	/*Looks up the index of every protein in the ProteinCollection*/
+	resolve(clusters, 0, size());
+}
+
+void NeighborhoodStore::resolve(ProteinCollection &clusters, unsigned int first, unsigned int last) {
+	std::string pid;
+	indexes.resize(pids.size());
+	for (unsigned int p = offsets[first]; p < offsets[last]; p++) {
+		pid.clear();
+		codec.decode(pids[p], pid);
+		indexes[p] = clusters.get_index(pid);
+	}
+}
+
+void NeighborhoodStore::resolve(const CompiledGraph &graph, unsigned int first, unsigned int last) {
+	std::string pid;
+	indexes.resize(pids.size());
+	for (unsigned int p = offsets[first]; p < offsets[last]; p++) {
+		pid.clear();
+		codec.decode(pids[p], pid);
+		indexes[p] = graph.find(pid);
+	}
+}
+
+void NeighborhoodStore::set_seed_window(int flank) {
+	/*Restricts each neighborhood to flank proteins on each side of its seeds*/
+	set_seed_window(flank, 0, size());
+}
+
+void NeighborhoodStore::set_seed_window(int flank, unsigned int begin, unsigned int end) {
+	for (unsigned int n = begin; n < end; n++) {
+		if (seed_offsets[n] == seed_offsets[n + 1]) continue;
+		long first = *std::min_element(seeds.begin() + seed_offsets[n], seeds.begin() + seed_offsets[n + 1]) - (long)flank;
+		long last = *std::max_element(seeds.begin() + seed_offsets[n], seeds.begin() + seed_offsets[n + 1]) + (long)flank;
+		window_begins[n] = std::max(first, (long)offsets[n]);
+		window_ends[n] = std::min(last + 1, (long)offsets[n + 1]);
+	}
+}
+
+int NeighborhoodStore::unique_protein_count() const {
+	/*Returns the number of unique proteins in the neighborhoods*/
+	HashTable protein_set;
+	for (unsigned int p = 0; p < pids.size(); p++)
+		protein_set.insert(pids[p]);
+	return protein_set.size();
+}
+
+int NeighborhoodStore::seed_index(unsigned int n) const {
+	/*Returns the position of the first seed in the window, or -1*/
+	if (seed_offsets[n] == seed_offsets[n + 1]) return -1;
+	return (int)seeds[seed_offsets[n]] - (int)window_begins[n];
+}
+
+std::vector<std::string> NeighborhoodStore::protein_fields(unsigned int n, int index) const {
+	/*Reads the lines of neighborhood n in the neighborhoods file up to the one of the protein*/
+	std::vector<std::string> split_line;
+	if (file_offsets[n] < 0) return split_line;
+
+	std::ifstream file(filenames[file_ids[n]].c_str());
+	std::string line;
+	file.seekg(file_offsets[n]);
+	std::getline(file, line); //ORGANISM line
+
+	int remaining = window_begins[n] - offsets[n] + index;
+	while (std::getline(file, line)) {
+		split_line = split(line, " \t");
+		if (is_protein_line(split_line) && remaining-- == 0)
+			return split_line;
+	}
+	return std::vector<std::string>();
+}
+
+std::string NeighborhoodStore::get_locus(unsigned int n, int index) const {
+	std::vector<std::string> fields = protein_fields(n, index);
+	return fields.size() > 7 ? fields[7] : ".";
+}
+
+std::string NeighborhoodStore::get_product(unsigned int n, int index) const {
+	/*The product is the rest of the line, and may have spaces*/
+	std::vector<std::string> fields = protein_fields(n, index);
+	if (fields.size() <= 9) return ".";
+	std::string product = fields[9];
+	for (unsigned int i = 10; i < fields.size(); i++)
+		product += " " + fields[i];
+	return product;
+}
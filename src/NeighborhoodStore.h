@@ -0,0 +1,136 @@
+#ifndef __NEIGHBORHOOD_STORE_H__
+#define __NEIGHBORHOOD_STORE_H__
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "AccessionCodec.h"
+#include "HashTable.h"
+#include "ProteinCollection.h"
+#include "CompiledGraph.h"
+
+/*Every genomic neighborhood of a dataset, kept as arrays with one position per protein (struct of arrays): each
+ *neighborhood is a range of consecutive positions, so comparing two of them streams over a few compact arrays.
+ *Only what the comparisons need is in memory: the packed pid, the coordinates and the ProteinCollection index of each
+ *protein. Its locus and product are read back from the neighborhoods file when asked for.
+ *A neighborhood can be restricted to a window of its proteins (see set_seed_window): the proteins of a neighborhood
+ *(protein_count, first_protein, indexes, ...) are then the ones of its window. Read one with GenomicNeighborhood.*/
+class NeighborhoodStore {
+
+	AccessionCodec codec;                 //pids of the proteins
+	HashTable accession_ids;              //interned accessions of the neighborhoods...
+	std::vector<std::string> accession_names; //...and their text
+
+	//One position per protein, the neighborhoods one after the other
+	std::vector<unsigned long long> pids; //packed pid (see AccessionCodec)
+	std::vector<int> cds_begins;
+	std::vector<int> cds_ends;
+	std::vector<long> indexes;            //index in the ProteinCollection, -1 if absent (see resolve)
+
+	//One position per neighborhood
+	std::vector<unsigned int> offsets;    //first protein, followed by the end of the last neighborhood
+	std::vector<int> accessions;          //id of the accession
+	std::vector<unsigned int> window_begins; //first protein of the window
+	std::vector<unsigned int> window_ends;   //end of the window
+	std::vector<unsigned int> seed_offsets;  //first seed in seeds, followed by the end of the last neighborhood
+	std::vector<long long> file_offsets;  //position of the ORGANISM line in the neighborhoods file, -1 if not read from it
+	std::vector<int> file_ids;            //neighborhoods file it was read from (see filenames)
+
+	std::vector<unsigned int> seeds;      //positions of the seed proteins
+	std::vector<std::string> filenames;   //neighborhoods files, for the locus and product of the proteins
+
+	/*Receives a neighborhood and the index of one of its proteins.
+	 *Returns the fields of the line of the protein in the neighborhoods file (empty if not read from it)*/
+	std::vector<std::string> protein_fields(unsigned int n, int index) const;
+
+	public:
+
+		NeighborhoodStore();
+
+		/*Receives a genomic neighborhood filename and adds its neighborhoods to the store (after the ones of the
+		 *files loaded before, if any)*/
+		void load(const std::string &neighborhoods_filename);
+
+		/*Receives a line of a genomic neighborhoods file (e.g. read from a stream), at file_offset in the file if
+		 *read from one, and adds what it has to the store. Returns true if it starts a new neighborhood*/
+		bool add_line(const std::string &line, long long file_offset = -1);
+
+		/*Starts a new neighborhood with the given accession code. file_offset is the position of its ORGANISM line
+		 *in the neighborhoods file, if read from it*/
+		void add_neighborhood(const std::string &accession, long long file_offset = -1);
+
+		/*Receives the pid and cds (e.g. "534..345") of a protein and adds it to the last neighborhood*/
+		void add_protein(const std::string &pid, const std::string &cds);
+
+		/*Makes the last protein added a seed of its neighborhood*/
+		void add_seed();
+
+		/*Looks up the index of every protein in the ProteinCollection. Must be called before the neighborhoods are
+		 *compared (indexes)*/
+		void resolve(ProteinCollection &clusters);
+
+		/*Same as above for the proteins of neighborhoods first to last - 1 only*/
+		void resolve(ProteinCollection &clusters, unsigned int first, unsigned int last);
+
+		/*Looks up the id of the proteins of neighborhoods first to last - 1 in a compiled graph instead (-1 if
+		 *absent), e.g. to know which of its similarities they need*/
+		void resolve(const CompiledGraph &graph, unsigned int first, unsigned int last);
+
+		/*Restricts each neighborhood to a window with flank proteins on each side of its seeds. The proteins are not
+		 *copied. Neighborhoods without seeds are kept whole*/
+		void set_seed_window(int flank);
+
+		/*Same as above for neighborhoods begin to end - 1 only*/
+		void set_seed_window(int flank, unsigned int begin, unsigned int end);
+
+		/*Returns the number of neighborhoods*/
+		unsigned int size() const {return accessions.size();}
+
+		/*Returns the number of proteins of all the neighborhoods (whole, even if restricted to a window)*/
+		unsigned int total_proteins() const {return pids.size();}
+
+		/*Returns the number of unique proteins in the neighborhoods*/
+		int unique_protein_count() const;
+
+		/*Returns the accession code of neighborhood n*/
+		const std::string &get_accession(unsigned int n) const {return accession_names[accessions[n]];}
+
+		/*Returns the number of proteins of neighborhood n*/
+		int protein_count(unsigned int n) const {return window_ends[n] - window_begins[n];}
+
+		/*Returns the position of the first protein of neighborhood n among the proteins of all the neighborhoods*/
+		unsigned int first_protein(unsigned int n) const {return window_begins[n];}
+
+		/*Returns the ProteinCollection indexes of the proteins of neighborhood n, one after the other*/
+		const long *protein_indexes(unsigned int n) const {return indexes.data() + window_begins[n];}
+
+		/*Returns the position of the first seed among the proteins of neighborhood n, or -1 if it has no seed*/
+		int seed_index(unsigned int n) const;
+
+		/*Returns the number of seeds of neighborhood n and their positions among the proteins of all the
+		 *neighborhoods*/
+		int seed_count(unsigned int n) const {return seed_offsets[n + 1] - seed_offsets[n];}
+		const unsigned int *seed_positions(unsigned int n) const {return seeds.data() + seed_offsets[n];}
+
+		/*Returns the first coordinate of neighborhood n (the whole neighborhood, even if restricted to a window)*/
+		int get_first_cds(unsigned int n) const {return cds_begins[offsets[n]];}
+
+		/*Returns the last coordinate of neighborhood n*/
+		int get_last_cds(unsigned int n) const {return cds_ends[offsets[n + 1] - 1];}
+
+		/*The protein at position p among the proteins of all the neighborhoods: its packed pid, its first
+		 *and last coordinates and its pid appended to a string (e.g. an output buffer)*/
+		unsigned long long pid_key(unsigned int p) const {return pids[p];}
+		int cds_begin(unsigned int p) const {return cds_begins[p];}
+		int cds_end(unsigned int p) const {return cds_ends[p];}
+		void append_pid(std::string &buffer, unsigned int p) const {codec.decode(pids[p], buffer);}
+
+		/*Returns the locus and the product of a protein of neighborhood n, read from the neighborhoods file
+		 *("." if not read from it)*/
+		std::string get_locus(unsigned int n, int index) const;
+		std::string get_product(unsigned int n, int index) const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "ProteinCollection.h"
 #include <iostream>
+#include <cstdlib>
 
 /**
  * Creates object with known number of nodes to be added
@@ -11,19 +12,25 @@ ProteinCollection::ProteinCollection(size_t n_nodes)
 }
 
 /**
- * Adds node with string identifier
+ * Adds node with string identifier. Its index is its id in the interner, so nodes are numbered in order of addition;
+ * the adjacency list grows if more nodes than expected are added.
  */
 void ProteinCollection::add_protein(const std::string& node) {
-	auto new_id = nodes.size();
-	nodes.emplace(node, node_info_t { new_id, false });
+	size_t id = nodes.insert(codec.encode(node));
+	if (id >= adj.size())
+		adj.resize(id + 1);
 }
 
 /**
  * Adds edge connecting two existing nodes with given weight
  */
 void ProteinCollection::connect_proteins(const std::string& node1, const std::string& node2, double weight) {
-    auto x = nodes.at(node1).index;
- 	auto y = nodes.at(node2).index;
+	long x = get_index(node1);
+	long y = get_index(node2);
+	if (x < 0 || y < 0) {
+		std::cerr << "ERROR: connecting proteins that were not added: " << node1 << " " << node2 << "\n";
+		exit(1);
+	}
 
 	//DEBUG
  	/*std::cerr << node1 << std::endl;
@@ -37,6 +44,13 @@ void ProteinCollection::connect_proteins(const std::string& node1, const std::st
 	}
 }
 
+/**
+ * Adds edge connecting the nodes with the given indexes with given weight
+ */
+void ProteinCollection::connect_proteins(long index1, long index2, double weight) {
+	adj[std::max(index1, index2)].emplace(std::min(index1, index2), weight);
+}
+
 /**
  * Adds two nodes and connects them with given weight
  */
@@ -50,15 +64,11 @@ void ProteinCollection::add_connected_proteins(const std::string& node1, const s
  * @returns True if given nodes are directly connected and false otherwise.
  */
 bool ProteinCollection::are_connected(const std::string& node1, const std::string& node2) {
-
-	try{
-    	auto x = nodes.at(node1).index;
-  		auto y = nodes.at(node2).index;
-		return x >= y ? adj[x].count(y) : adj[y].count(x);
-	}
-	catch(...){
+	long x = get_index(node1);
+	long y = get_index(node2);
+	if (x < 0 || y < 0)
 		return false;
-	}
+	return x >= y ? adj[x].count(y) : adj[y].count(x);
 }
 
 /**
@@ -67,20 +77,39 @@ bool ProteinCollection::are_connected(const std::string& node1, const std::strin
  */
 double ProteinCollection::get_similarity(const std::string& node1,
 	 									 const std::string& node2) {
+	return get_similarity(get_index(node1), get_index(node2));
+}
 
-	try{
-		auto x = nodes.at(node1).index;
-		auto y = nodes.at(node2).index;
-		try{
-			return x >= y ? adj[x].at(y) : adj[y].at(x);
-		}
-		catch(...){
-			return 0.0;
-		}
-	}
-	catch(...){
+/**
+ * @returns Weight of the edge connecting the nodes with the given indexes, or 0.0 if they are not connected (or one
+ * of them is not in the graph).
+ */
+double ProteinCollection::get_similarity(long index1, long index2) {
+	if (index1 < 0 || index2 < 0)
 		return 0.0;
-	}
+
+	long x = std::max(index1, index2);
+	long y = std::min(index1, index2);
+	auto edge = adj[x].find(y);
+	return edge == adj[x].end() ? 0.0 : edge->second;
+}
+
+/**
+ * @returns Index of the given node or -1 if it is not in the graph.
+ */
+long ProteinCollection::get_index(const std::string& node) {
+	unsigned long long key;
+	if (!codec.find(node, key))
+		return -1;
+	return nodes.get_id(key);
+}
+
+/**
+ * @returns Nodes connected to the node with the given index whose index is smaller or equal to it, with the
+ * weights of the edges. Every edge is stored only once, at its larger index.
+ */
+const std::unordered_map<int, double>& ProteinCollection::lower_neighbors(size_t index) {
+	return adj[index];
 }
 
 void ProteinCollection::normalize() {
@@ -89,7 +118,10 @@ void ProteinCollection::normalize() {
 		for (typename std::unordered_map<int, double>::iterator it = adj[i].begin(); it != adj[i].end(); ++it)
 			if (it->second > max_score)
 				max_score = it->second;
+	normalize(max_score);
+}
 
+void ProteinCollection::normalize(double max_score) {
 	for(unsigned int i = 0; i < adj.size(); i++)
 		for (typename std::unordered_map<int, double>::iterator it = adj[i].begin(); it != adj[i].end(); ++it)
 			it->second = it->second/max_score;
@@ -102,13 +134,12 @@ void ProteinCollection::normalize() {
 std::vector<std::vector<std::string>> ProteinCollection::connected_components(double weight) {
 
 	std::vector<std::vector<std::string> > components;
-	for(typename std::unordered_map<std::string, node_info_t>::iterator it = nodes.begin(); it != nodes.end(); ++it)
-		(it->second).visited = false;
+	std::vector<char> visited(nodes.size(), false);
 
- 	for(typename std::unordered_map<std::string, node_info_t>::iterator it = nodes.begin(); it != nodes.end(); ++it)
-		if (!(it->second).visited)
+ 	for(size_t n = 0; n < nodes.size(); n++)
+		if (!visited[n])
 	  	//For every unvisited node, runs DFS to get all connected nodes
-	  	DFS_vector_fill(it, components, weight);
+	  	DFS_vector_fill(n, visited, components, weight);
   	return components;
 }
 
@@ -116,35 +147,25 @@ std::vector<std::vector<std::string>> ProteinCollection::connected_components(do
 * Runs DFS from a starting node "n" and adds a vector to components with all the nodes in the same
 * connected component as n.
 */
-void ProteinCollection::DFS_vector_fill(typename std::unordered_map<std::string, node_info_t>::iterator n,
+void ProteinCollection::DFS_vector_fill(size_t n, std::vector<char> &visited,
 										std::vector<std::vector<std::string> > &components,
 	  									double weight) {
 
-	std::stack<typename std::unordered_map<std::string, node_info_t>::iterator> my_stack;
+	std::stack<size_t> my_stack;
 	std::vector<std::string> aux;
 	my_stack.push(n);
 	while (!my_stack.empty()) {
 		n = my_stack.top();
 		my_stack.pop();
-		if (!(n->second).visited) {
-			aux.push_back(n->first);
-			(n->second).visited = true;
+		if (!visited[n]) {
+			aux.push_back(codec.decode(nodes.get_integer_key(n)));
+			visited[n] = true;
 		}
-		for(typename std::unordered_map<std::string, node_info_t>::iterator it = nodes.begin(); it != nodes.end(); ++it){
-			if (!(it->second).visited) {
-
-				try {
-					if (adj[(n->second).index].at((it->second).index) >= weight)
-					my_stack.push(it);
-				}
-
-				catch(...){}
-		/*for(size_t i = 0; i < adj[(n->second).index].size(); i++){
-			if(adj[(n->second).index][i].first == (it->second).index && adj[(n->second).index][i].second >= weight) {
-			my_stack.push(it);
-			break;
-			}*/
-			}
+		for(size_t m = 0; m < nodes.size(); m++) {
+			if (visited[m]) continue;
+			auto edge = adj[n].find(m);
+			if (edge != adj[n].end() && edge->second >= weight)
+				my_stack.push(m);
 		}
 	}
 	components.push_back(aux);
@@ -6,16 +6,15 @@
 #include <string>
 #include <unordered_map>
 #include <stack>
+#include <algorithm>
+#include "HashTable.h"
+#include "AccessionCodec.h"
 
 /*Undirected edge-weighted graph with adjacency lists implementation*/
 class ProteinCollection {
 
-	struct node_info_t {
-		size_t index;
-		bool visited;
-	};
-
-	std::unordered_map<std::string, node_info_t> nodes; //nodes are proteins
+	AccessionCodec codec; //packs the names of the proteins into integer keys
+	HashTable nodes;      //nodes are proteins, indexed by the id of their key in the interner
 	std::vector<std::unordered_map<int, double>> adj; //Adjacency list
 
 	public:
@@ -31,6 +30,9 @@ class ProteinCollection {
 		/*Adds connection between two existing proteins with given similarity*/
 		void connect_proteins(const std::string& node1, const std::string& node2, double weight);
 
+		/*Same as above, receiving the indexes of the proteins (see get_index)*/
+		void connect_proteins(long index1, long index2, double weight);
+
 		/*Adds two proteins and connects them with given similarity*/
 		void add_connected_proteins(const std::string& node1, const std::string& node2, double weight);
 
@@ -41,7 +43,23 @@ class ProteinCollection {
 		 *If not connected, returns 0.0*/
 		double get_similarity(const std::string& node1, const std::string& node2);
 
+		/*Same as above, receiving the indexes of the proteins (see get_index). Negative indexes are never connected*/
+		double get_similarity(long index1, long index2);
+
+		/*Returns the number of proteins*/
+		size_t size() const {return nodes.size();}
+
+		/*Returns the index of a protein, or -1 if it is not in the collection*/
+		long get_index(const std::string& node);
+
+		/*Returns the proteins connected to the protein with the given index whose index is smaller or equal to it,
+		 *with their similarities (each connection is stored only once, at its larger index)*/
+		const std::unordered_map<int, double>& lower_neighbors(size_t index);
+
+		/*Divides every similarity by the largest one (or by max_score, e.g. the largest one of a larger graph
+		 *this collection is part of)*/
 		void normalize();
+		void normalize(double max_score);
 		
 		/*Returns vector of connected components where each position is a vector of nodes in the same
 		 *component*/
@@ -50,7 +68,7 @@ class ProteinCollection {
 	private:
 
 		/*connected_components auxiliar function*/
-		void DFS_vector_fill(typename std::unordered_map<std::string, node_info_t>::iterator n,
+		void DFS_vector_fill(size_t n, std::vector<char> &visited,
 							 std::vector<std::vector<std::string> > &components, double weight);
 };
 
@@ -0,0 +1,44 @@
+#include "SimilarityBlock.h"
+
+SimilarityBlock::SimilarityBlock()
+	: data(NULL), stride(0), n_rows(0), n_cols(0) {
+}
+
+/**
+ *Receives two genomic neighborhoods and a ProteinCollection.
+ *Stores in position (i, j) the similarity between the i-th protein of g1 and the j-th protein of g2.
+ */
+void SimilarityBlock::fill(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, ProteinCollection &clusters) {
+	fill(g1.indexes(), g1.protein_count(), g2.indexes(), g2.protein_count(), clusters);
+}
+
+/**
+ *Receives the ProteinCollection indexes of two sequences of proteins and the ProteinCollection.
+ *Stores in position (i, j) the similarity between the i-th protein of the rows and the j-th protein of the columns.
+ *The pairs are looked up by their indexes, so no protein is looked up by name.
+ *The storage is reused between calls, so filling blocks of similar sizes does not reallocate.
+ */
+void SimilarityBlock::fill(const long *row_indexes, int rows, const long *col_indexes, int cols, ProteinCollection &clusters) {
+	n_rows = rows;
+	n_cols = cols;
+	values.resize(n_rows*n_cols);
+
+	int k = 0;
+	for(int i = 0; i < n_rows; i++)
+		for(int j = 0; j < n_cols; j++)
+			values[k++] = clusters.get_similarity(row_indexes[i], col_indexes[j]);
+	data = values.data();
+	stride = n_cols;
+}
+
+/**
+ *Receives a filled block and the position and size of one of its sub-blocks.
+ *Makes this block a view of that sub-block: its similarities are read from parent, which must not be
+ *filled again while the view is in use.
+ */
+void SimilarityBlock::view(const SimilarityBlock &parent, int first_row, int first_col, int rows, int cols) {
+	data = parent.data + first_row*parent.stride + first_col;
+	stride = parent.stride;
+	n_rows = rows;
+	n_cols = cols;
+}
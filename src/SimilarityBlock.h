@@ -0,0 +1,49 @@
+#ifndef __SIMILARITY_BLOCK_H__
+#define __SIMILARITY_BLOCK_H__
+
+#include <vector>
+#include "Arena.h"
+#include "GenomicNeighborhood.h"
+#include "ProteinCollection.h"
+
+/*Dense matrix with the raw similarities between every protein of two genomic neighborhoods.
+ *Filled once per pair of neighborhoods and shared by all the scoring methods, so each protein pair
+ *is looked up in the ProteinCollection only once (by the indexes of the proteins, see NeighborhoodStore::resolve).
+ *A block can also be a view of a sub-block of another one (e.g. a window inside a larger region),
+ *without copying its similarities.*/
+class SimilarityBlock {
+
+	private:
+		std::vector<double> values; //row-major, n_rows x n_cols (unused by views)
+		const double *data;         //first similarity of the block, in values or in the viewed block
+		int stride;                 //distance between the rows in data
+		int n_rows;
+		int n_cols;
+
+	public:
+
+		SimilarityBlock();
+
+		/*Receives two genomic neighborhoods and a ProteinCollection.
+		 *Stores in position (i, j) the similarity between the i-th protein of g1 and the j-th protein of g2*/
+		void fill(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, ProteinCollection &clusters);
+
+		/*Same as above for two sequences of proteins given by their ProteinCollection indexes (e.g. a region made
+		 *of several neighborhoods)*/
+		void fill(const long *row_indexes, int rows, const long *col_indexes, int cols, ProteinCollection &clusters);
+
+		/*Makes this block a view of the rows x cols sub-block of parent starting at (first_row, first_col).
+		 *The view is valid while parent is not filled again*/
+		void view(const SimilarityBlock &parent, int first_row, int first_col, int rows, int cols);
+
+		/*Returns the similarity between the i-th protein of g1 and the j-th protein of g2*/
+		double at(int i, int j) const {return data[i*stride + j];}
+
+		/*Returns number of proteins of g1*/
+		int rows() const {return n_rows;}
+
+		/*Returns number of proteins of g2*/
+		int cols() const {return n_cols;}
+};
+
+#endif
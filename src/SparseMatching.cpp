@@ -0,0 +1,168 @@
+#include "SparseMatching.h"
+
+static const long long INF = std::numeric_limits<long long>::max()/4;
+
+/**
+ * Creates a graph with n_left and n_right vertices on each side and no edges
+ */
+SparseMatching::SparseMatching(int n_left, int n_right)
+	: n_left(n_left), n_right(n_right), adj(n_left), left_match(n_left, -1), right_match(n_right, -1),
+	  match_weight(n_left, 0), total(0) {
+}
+
+/**
+ * Adds an edge with positive weight between left vertex u and right vertex v
+ */
+void SparseMatching::add_edge(int u, int v, int weight) {
+	adj[u].push_back(edge_t {v, weight});
+}
+
+/**
+ * @returns Number of edges added.
+ */
+long long SparseMatching::edge_count() const {
+	long long count = 0;
+	for (int u = 0; u < n_left; u++)
+		count += adj[u].size();
+	return count;
+}
+
+/**
+ * @returns Upper bound on the weight of the matching: each vertex is matched at most once, so neither the left nor
+ * the right vertices can add up to more than their heaviest edges.
+ */
+long long SparseMatching::upper_bound() const {
+	arena_vector<long long> right_max(n_right, 0);
+	long long left_total = 0, right_total = 0;
+	for (int u = 0; u < n_left; u++) {
+		long long left_max = 0;
+		for (unsigned int k = 0; k < adj[u].size(); k++) {
+			left_max = std::max(left_max, (long long)adj[u][k].weight);
+			right_max[adj[u][k].to] = std::max(right_max[adj[u][k].to], (long long)adj[u][k].weight);
+		}
+		left_total += left_max;
+	}
+	for (int v = 0; v < n_right; v++)
+		right_total += right_max[v];
+	return std::min(left_total, right_total);
+}
+
+/**
+ * Computes a maximum weight matching as a min cost flow source -> left -> right -> sink with edge costs -weight.
+ * Each round finds the shortest augmenting path with Dijkstra over reduced costs and stops when it no longer
+ * increases the weight. Potentials keep reduced costs nonnegative; the virtual source always has potential 0.
+ * @returns Weight of the matching.
+ */
+long long SparseMatching::solve() {
+	arena_vector<long long> pot_left(n_left, 0), pot_right(n_right, 0);
+	arena_vector<long long> dist_left(n_left), dist_right(n_right);
+	arena_vector<int> prev_left(n_left), prev_right(n_right);
+	typedef std::pair<long long, int> queue_item_t; //distance, vertex (right vertices are shifted by n_left)
+
+	//Feasible initial potentials: every left->right edge has reduced cost -w - pot_right >= 0
+	for (int u = 0; u < n_left; u++)
+		for (unsigned int k = 0; k < adj[u].size(); k++)
+			pot_right[adj[u][k].to] = std::min(pot_right[adj[u][k].to], (long long)-adj[u][k].weight);
+	long long pot_sink = 0;
+	for (int v = 0; v < n_right; v++)
+		pot_sink = std::min(pot_sink, pot_right[v]);
+
+	while (true) {
+		std::priority_queue<queue_item_t, arena_vector<queue_item_t>, std::greater<queue_item_t> > my_queue;
+		dist_left.assign(n_left, INF);
+		dist_right.assign(n_right, INF);
+
+		for (int u = 0; u < n_left; u++) {
+			if (left_match[u] < 0) {
+				dist_left[u] = -pot_left[u];
+				prev_left[u] = -1;
+				my_queue.push(queue_item_t(dist_left[u], u));
+			}
+		}
+
+		while (!my_queue.empty()) {
+			queue_item_t item = my_queue.top();
+			my_queue.pop();
+			if (item.second < n_left) {
+				int u = item.second;
+				if (item.first != dist_left[u]) continue;
+				for (unsigned int k = 0; k < adj[u].size(); k++) {
+					int v = adj[u][k].to;
+					if (left_match[u] == v) continue; //matched edges only go right -> left
+					long long d = item.first - adj[u][k].weight + pot_left[u] - pot_right[v];
+					if (d < dist_right[v]) {
+						dist_right[v] = d;
+						prev_right[v] = u;
+						my_queue.push(queue_item_t(d, v + n_left));
+					}
+				}
+			}
+			else {
+				int v = item.second - n_left;
+				if (item.first != dist_right[v]) continue;
+				int u = right_match[v];
+				if (u < 0) continue; //free right vertices only lead to the sink
+				long long d = item.first + match_weight[u] + pot_right[v] - pot_left[u];
+				if (d < dist_left[u]) {
+					dist_left[u] = d;
+					prev_left[u] = v;
+					my_queue.push(queue_item_t(d, u));
+				}
+			}
+		}
+
+		//Shortest path to the sink goes through the best free right vertex
+		long long dist_sink = INF;
+		int best = -1;
+		for (int v = 0; v < n_right; v++) {
+			if (right_match[v] < 0 && dist_right[v] < INF && dist_right[v] + pot_right[v] - pot_sink < dist_sink) {
+				dist_sink = dist_right[v] + pot_right[v] - pot_sink;
+				best = v;
+			}
+		}
+		if (best < 0 || dist_sink + pot_sink >= 0) //no augmenting path increases the weight
+			break;
+
+		for (int u = 0; u < n_left; u++)
+			pot_left[u] += std::min(dist_left[u], dist_sink);
+		for (int v = 0; v < n_right; v++)
+			pot_right[v] += std::min(dist_right[v], dist_sink);
+		pot_sink += dist_sink;
+
+		//Flips the augmenting path
+		for (int v = best; v >= 0; ) {
+			int u = prev_right[v];
+			int next = prev_left[u];
+			for (unsigned int k = 0; k < adj[u].size(); k++)
+				if (adj[u][k].to == v)
+					match_weight[u] = adj[u][k].weight;
+			left_match[u] = v;
+			right_match[v] = u;
+			v = next;
+		}
+	}
+
+	total = 0;
+	for (int u = 0; u < n_left; u++)
+		if (left_match[u] >= 0)
+			total += match_weight[u];
+	return total;
+}
+
+/**
+ * @returns The matched edges, with their weights, in the same format as Hungarian::get_assignments(). As the
+ * Hungarian pads the matrix to a square, every vertex is paired: the unmatched ones with an index past the end of
+ * the other side.
+ */
+assignments_t SparseMatching::get_assignments() {
+	assignments_t assignments;
+	for (int u = 0; u < n_left; u++)
+		if (left_match[u] >= 0)
+			assignments.insert(std::make_pair(std::make_pair(u, left_match[u]), match_weight[u]));
+		else
+			assignments.insert(std::make_pair(std::make_pair(u, n_right + u), 0));
+	for (int v = 0; v < n_right; v++)
+		if (right_match[v] < 0)
+			assignments.insert(std::make_pair(std::make_pair(n_left + v, v), 0));
+	return assignments;
+}
@@ -0,0 +1,51 @@
+#ifndef __SPARSE_MATCHING_H__
+#define __SPARSE_MATCHING_H__
+
+#include <vector>
+#include <map>
+#include <queue>
+#include <limits>
+#include "Arena.h"
+
+/*Maximum weight matching of a sparse bipartite graph with positive integer weights.
+ *Successive shortest paths with Dijkstra and potentials over an edge list: O(n*E*log(V)) time and O(V+E) memory,
+ *instead of the O(n^3) time and O(n^2) memory of the dense Hungarian.*/
+class SparseMatching {
+
+	struct edge_t {
+		int to;
+		int weight;
+	};
+
+	int n_left;
+	int n_right;
+	arena_vector<arena_vector<edge_t> > adj; //edges of the left vertices
+	arena_vector<int> left_match;            //right vertex matched to each left vertex, -1 if unmatched
+	arena_vector<int> right_match;           //left vertex matched to each right vertex, -1 if unmatched
+	arena_vector<int> match_weight;          //weight of the edge matched to each left vertex
+	long long total;
+
+	public:
+
+		/*Creates a graph with n_left and n_right vertices on each side and no edges*/
+		SparseMatching(int n_left, int n_right);
+
+		/*Adds an edge with positive weight between left vertex u and right vertex v*/
+		void add_edge(int u, int v, int weight);
+
+		/*Returns the number of edges added*/
+		long long edge_count() const;
+
+		/*Returns an upper bound on the weight of the matching (without solving it): the smaller of the sums of the
+		 *heaviest edge of each left vertex and of each right vertex*/
+		long long upper_bound() const;
+
+		/*Computes a maximum weight matching and returns its weight*/
+		long long solve();
+
+		/*Returns the matched edges in the same format as Hungarian::get_assignments(): the unmatched vertices are paired
+		 *with padding, left vertex u with (u, n_right + u) and right vertex v with (n_left + v, v), with weight 0*/
+		assignments_t get_assignments();
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "colinear_scoring.h"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ *Dynamic programming table of the alignment stored by anti-diagonals: cell (i, j) of the usual table, with i and j
+ *starting at 1, is h[(i + j)*stride + i]. Cells in the same anti-diagonal only depend on the two previous ones, so
+ *each anti-diagonal is computed with contiguous (vectorizable) loads. Row and column 0 are never written and stay 0.
+ */
+typedef struct {
+    int rows;
+    int cols;
+    int stride;
+    arena_vector<double> h;
+    arena_vector<double> w; //weights gathered by anti-diagonal, same layout as h
+} colinear_table_t;
+
+/**
+ *Receives the similarity between two proteins and a threshold value.
+ *Returns the similarity if it reaches the threshold and 0 otherwise.
+ */
+static double clustering_value(double similarity, double stringency) {
+    return similarity >= stringency ? similarity : 0;
+}
+
+/**
+ *Computes the anti-diagonal d of the table: h(i, j) = max(0, h(i-1, j-1) + w(i, j), h(i-1, j) - gap, h(i, j-1) - gap)
+ *for every i + j = d.
+ */
+static void fill_anti_diagonal(colinear_table_t &table, int d, double gap_penalty) {
+    int first = std::max(1, d - table.cols);
+    int last = std::min(table.rows, d - 1);
+    double *cur = &table.h[d*table.stride];
+    const double *prev = &table.h[(d - 1)*table.stride];
+    const double *prev2 = &table.h[(d - 2)*table.stride];
+    const double *w = &table.w[d*table.stride];
+    int i = first;
+
+#if defined(__AVX__)
+    __m256d gap = _mm256_set1_pd(gap_penalty);
+    __m256d zero = _mm256_setzero_pd();
+    for (; i + 3 <= last; i += 4) {
+        __m256d diag = _mm256_add_pd(_mm256_loadu_pd(prev2 + i - 1), _mm256_loadu_pd(w + i));
+        __m256d up = _mm256_sub_pd(_mm256_loadu_pd(prev + i - 1), gap);
+        __m256d left = _mm256_sub_pd(_mm256_loadu_pd(prev + i), gap);
+        _mm256_storeu_pd(cur + i, _mm256_max_pd(_mm256_max_pd(diag, up), _mm256_max_pd(left, zero)));
+    }
+#elif defined(__SSE2__)
+    __m128d gap = _mm_set1_pd(gap_penalty);
+    __m128d zero = _mm_setzero_pd();
+    for (; i + 1 <= last; i += 2) {
+        __m128d diag = _mm_add_pd(_mm_loadu_pd(prev2 + i - 1), _mm_loadu_pd(w + i));
+        __m128d up = _mm_sub_pd(_mm_loadu_pd(prev + i - 1), gap);
+        __m128d left = _mm_sub_pd(_mm_loadu_pd(prev + i), gap);
+        _mm_storeu_pd(cur + i, _mm_max_pd(_mm_max_pd(diag, up), _mm_max_pd(left, zero)));
+    }
+#endif
+    for (; i <= last; i++)
+        cur[i] = std::max(std::max(prev2[i - 1] + w[i], prev[i - 1] - gap_penalty),
+                          std::max(prev[i] - gap_penalty, 0.0));
+}
+
+/**
+ *Receives the similarity block, the protein stringency, the gap penalty and the orientation of g2.
+ *Fills the table and returns the weight of the best alignment, storing its last cell in best_i and best_j.
+ */
+static double fill_table(colinear_table_t &table, const SimilarityBlock &block, double prot_stringency,
+                         double gap_penalty, bool reverse, int &best_i, int &best_j) {
+    table.rows = block.rows();
+    table.cols = block.cols();
+    table.stride = table.rows + 1;
+    table.h.assign((table.rows + table.cols + 1)*table.stride, 0);
+    table.w.assign(table.h.size(), 0);
+
+    for (int i = 1; i <= table.rows; i++)
+        for (int j = 1; j <= table.cols; j++)
+            table.w[(i + j)*table.stride + i] =
+                clustering_value(block.at(i - 1, reverse ? table.cols - j : j - 1), prot_stringency);
+
+    double best = 0;
+    best_i = best_j = 0;
+    for (int d = 2; d <= table.rows + table.cols; d++) {
+        fill_anti_diagonal(table, d, gap_penalty);
+        for (int i = std::max(1, d - table.cols); i <= std::min(table.rows, d - 1); i++)
+            if (table.h[d*table.stride + i] > best) {
+                best = table.h[d*table.stride + i];
+                best_i = i;
+                best_j = d - i;
+            }
+    }
+    return best;
+}
+
+/**
+ *Receives a filled table, the last cell of the best alignment, the gap penalty and the orientation of g2.
+ *Walks the alignment back and fills the assignments with the aligned proteins (indexes of the block).
+ */
+static void traceback(colinear_table_t &table, int i, int j, double gap_penalty, bool reverse,
+                      assignments_t &assignments) {
+    int s = table.stride;
+    while (i > 0 && j > 0) {
+        double h = table.h[(i + j)*s + i];
+        double w = table.w[(i + j)*s + i];
+        if (h <= 0)
+            break;
+        if (h == table.h[(i + j - 2)*s + i - 1] + w) {
+            if (w > 0)
+                assignments[std::make_pair(i - 1, reverse ? table.cols - j : j - 1)] = (int)(1000000*w);
+            i--;
+            j--;
+        }
+        else if (h == table.h[(i + j - 1)*s + i - 1] - gap_penalty)
+            i--;
+        else if (h == table.h[(i + j - 1)*s + i] - gap_penalty)
+            j--;
+        else
+            break;
+    }
+}
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the protein stringency, the penalty of each protein
+ *left unpaired inside the alignment and whether g2 should also be aligned in reverse order.
+ *Computes the maximum weight order-preserving (colinear) alignment of the two neighborhoods, fills the
+ *assignments with the aligned proteins and returns the weight of the alignment.
+ *The alignment is local: it starts and ends anywhere, so only the gaps inside it are penalized. With a gap penalty
+ *of 0 it is the maximum weight common subsequence of the two neighborhoods.
+ */
+double colinear_alignment(const SimilarityBlock &block, double prot_stringency, double gap_penalty, bool reverse,
+                          assignments_t &assignments) {
+    colinear_table_t table;
+    int best_i, best_j;
+    bool best_reverse = false;
+    double best = fill_table(table, block, prot_stringency, gap_penalty, false, best_i, best_j);
+
+    if (reverse) {
+        colinear_table_t reverse_table;
+        int reverse_i, reverse_j;
+        double reverse_best = fill_table(reverse_table, block, prot_stringency, gap_penalty, true, reverse_i, reverse_j);
+        if (reverse_best > best) {
+            std::swap(table, reverse_table);
+            best = reverse_best;
+            best_i = reverse_i;
+            best_j = reverse_j;
+            best_reverse = true;
+        }
+    }
+
+    assignments.clear();
+    traceback(table, best_i, best_j, gap_penalty, best_reverse, assignments);
+    return best;
+}
+
+/**
+ *Receives the weight of the colinear alignment and a normalizing factor (length of the longest neighborhood).
+ *Returns the colinear score.
+ */
+double colinear_scoring(double alignment_weight, int length) {
+    return alignment_weight/length;
+}
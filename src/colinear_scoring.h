@@ -0,0 +1,24 @@
+#ifndef __COLINEAR_SCORING_H__
+#define __COLINEAR_SCORING_H__
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include "SimilarityBlock.h"
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the protein stringency, the penalty of each protein
+ *left unpaired inside the alignment and whether g2 should also be aligned in reverse order.
+ *Computes the maximum weight order-preserving (colinear) alignment of the two neighborhoods, fills the
+ *assignments with the aligned proteins and returns the weight of the alignment.
+ */
+double colinear_alignment(const SimilarityBlock &block, double prot_stringency, double gap_penalty, bool reverse,
+                          assignments_t &assignments);
+
+/**
+ *Receives the weight of the colinear alignment and a normalizing factor (length of the longest neighborhood).
+ *Returns the colinear score.
+ */
+double colinear_scoring(double alignment_weight, int length);
+
+#endif
@@ -1,10 +1,10 @@
-#include "genome_grouping.h"
+#include "genome_grouping_common.h"
 
 /**
  *Receives a string and delimiters.
  *Splits the string in a vector according to delimiters
  */
-static std::vector<std::string> split(const std::string& in, const std::string& delim) {
+std::vector<std::string> split(const std::string& in, const std::string& delim) {
    std::string::size_type start = in.find_first_not_of(delim), end = 0;
 
    std::vector<std::string> out;
@@ -23,186 +23,1011 @@ static std::vector<std::string> split(const std::string& in, const std::string&
 
 /**
  *Receives a genomic neighborhood filename.
- *Returns a vector of genomic neighborhoods, filled with the information from the file.
- */
-std::vector<GenomicNeighborhood> parse_neighborhoods(const std::string &neighborhoods_filename) {
-     std::ifstream file;
-     std::string line;
-     std::vector<std::string> split_line;
-     std::vector<GenomicNeighborhood> neighborhoods;
-
-     file.open(neighborhoods_filename.c_str());
-     if (file.fail()) {
-         std::cerr << "ERROR: trouble opening the neighborhoods file\n";
-         exit(1);
-     }
-
-     int organism_index = -1;
-     while(std::getline(file, line)) {
-         split_line = split(line, " \t");
-
-         if (split_line[0] == "ORGANISM") { //beginning of organism
-             organism_index++;
-             for (unsigned int accession_index = 0; accession_index < split_line.size(); accession_index++){ //find index of accession code
-                 if (split_line[accession_index] == "accession") {
-                     accession_index += 3;
-                     neighborhoods.emplace_back(GenomicNeighborhood(split_line[accession_index]));
-                     break;
-                }
-             }
-         }
- 		else if (split_line[0] == "." && split_line[1] != "cds") //protein
-             neighborhoods[organism_index].add_protein(split_line[7], split_line[4], split_line[1]); //locus pid cds
-
- 		else if (split_line[0] == "-->") { //seed protein
-             neighborhoods[organism_index].add_protein(split_line[7], split_line[4], split_line[1]); //locus pid cds
-             neighborhoods[organism_index].add_seed(split_line[7], split_line[4], split_line[1]); //locus pid cds
-         }
-     }
-     file.close();
-     return neighborhoods;
- }
+ *Returns a store of genomic neighborhoods, filled with the information from the file.
+ */
+NeighborhoodStore parse_neighborhoods(const std::string &neighborhoods_filename) {
+    NeighborhoodStore neighborhoods;
+    neighborhoods.load(neighborhoods_filename);
+    return neighborhoods;
+}
+
+/**
+ *The neighborhoods of the previous run are compared by their accession, coordinates and proteins.
+ */
+unsigned int previous_neighborhoods(NeighborhoodStore &neighborhoods, const std::string &previous_filename) {
+    NeighborhoodStore previous = parse_neighborhoods(previous_filename);
+    bool prefix = previous.size() <= neighborhoods.size();
+    for (unsigned int n = 0; prefix && n < previous.size(); n++) {
+        prefix = previous.get_accession(n) == neighborhoods.get_accession(n) &&
+                 previous.get_first_cds(n) == neighborhoods.get_first_cds(n) &&
+                 previous.get_last_cds(n) == neighborhoods.get_last_cds(n) &&
+                 previous.protein_count(n) == neighborhoods.protein_count(n);
+        for (int i = 0; prefix && i < previous.protein_count(n); i++)
+            prefix = previous.pid_key(previous.first_protein(n) + i) == neighborhoods.pid_key(neighborhoods.first_protein(n) + i);
+    }
+    if (!prefix) {
+        std::cerr << "ERROR: the neighborhoods of " << previous_filename << " must be the first ones of the neighborhoods file\n";
+        exit(1);
+    }
+    return previous.size();
+}
+
+/**
+ *A run without queries would compare all the pairs of the references, as an ordinary run does.
+ */
+unsigned int reference_neighborhoods(NeighborhoodStore &neighborhoods, const std::string &reference_filename) {
+    unsigned int first_reference = neighborhoods.size();
+    if (first_reference == 0) {
+        std::cerr << "ERROR: comparing with reference neighborhoods requires at least one neighborhood to compare\n";
+        exit(1);
+    }
+    neighborhoods.load(reference_filename);
+    return first_reference;
+}
+
+/**
+ *Appends a number to a text buffer, formatted as an ostream would (6 significant digits)
+ */
+static void append_number(std::string &buffer, double value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%g", value);
+    buffer += text;
+}
+
+static void append_number(std::string &buffer, int value) {
+    char text[16];
+    snprintf(text, sizeof(text), "%d", value);
+    buffer += text;
+}
+
+/**
+ *Appends the accession and coordinates of a genomic neighborhood, separated by tabs, to a text buffer
+ */
+void append_neighborhood(std::string &buffer, const GenomicNeighborhood &g) {
+    buffer += g.get_accession();
+    buffer += '\t';
+    append_number(buffer, g.get_first_cds());
+    buffer += '\t';
+    append_number(buffer, g.get_last_cds());
+}
+
+/**
+ *Appends the coordinates of two genomic neighborhoods, separated by tabs, to a text buffer
+ */
+static void append_pair(std::string &buffer, const GenomicNeighborhood &g1, const GenomicNeighborhood &g2) {
+    append_neighborhood(buffer, g1);
+    buffer += '\t';
+    append_neighborhood(buffer, g2);
+}
+
 /**
  *Prints the score between two genomic neighborhoods in the standard format
  */
-static void output_score(GenomicNeighborhood &g1, GenomicNeighborhood &g2, double score, std::ofstream &output_file) {
-    output_file << g1.get_accession() << "\t" <<
-                   g1.get_first_cds() << "\t" <<
-                   g1.get_last_cds() << "\t" <<
-                   g2.get_accession() << "\t" <<
-                   g2.get_first_cds() << "\t" <<
-                   g2.get_last_cds() << "\t" <<
-                   score << "\n";
+void output_score(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, double score, std::string &output_file) {
+    append_pair(output_file, g1, g2);
+    output_file += '\t';
+    append_number(output_file, score);
+    output_file += '\n';
 }
 
 /**
  *Prints the chosen protein assignments to the pairings_file
  */
-static void output_pairings(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                            std::map<std::pair<int, int>,int> &assignments, std::ofstream &pairings_file) {
+static void output_pairings(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                            assignments_t &assignments, std::string &pairings_file) {
 
     //Writes header
-    pairings_file << ">" << g1.get_accession() << "\t" <<
-                            g1.get_first_cds() << "\t" <<
-                            g1.get_last_cds() << "\t" <<
-                            g2.get_accession() << "\t" <<
-                            g2.get_first_cds() << "\t" <<
-                            g2.get_last_cds() << "\n";
+    pairings_file += '>';
+    append_pair(pairings_file, g1, g2);
+    pairings_file += '\n';
 
     //Writes pairings
-    for (std::map<std::pair<int, int>,int>::iterator it = assignments.begin(); it != assignments.end(); ++it){
-        pairings_file << g1.get_pid(it->first.first) << "\t" <<
-                         g2.get_pid(it->first.second) << "\t" <<
-                         ((double)it->second)/1000000 << "\n";
+    for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it){
+        g1.append_pid(pairings_file, it->first.first);
+        pairings_file += '\t';
+        g2.append_pid(pairings_file, it->first.second);
+        pairings_file += '\t';
+        append_number(pairings_file, ((double)it->second)/1000000);
+        pairings_file += '\n';
     }
 }
 
 /**
  *Prints the chosen protein assignments to the pairings_file (treats each assignment as a pair of pairs of proteins)
  */
-static void output_pairingsO2(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                            std::map<std::pair<int, int>,int> &assignments, std::ofstream &pairings_file) {
+static void output_pairingsO2(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                              assignments_t &assignments, std::string &pairings_file) {
+
+    //Writes header
+    pairings_file += '>';
+    append_pair(pairings_file, g1, g2);
+    pairings_file += '\n';
+
+    //Writes pairings
+    for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it){
+        g1.append_pid(pairings_file, it->first.first);
+        pairings_file += '\t';
+        g1.append_pid(pairings_file, it->first.first + 1);
+        pairings_file += '\t';
+        g2.append_pid(pairings_file, it->first.second);
+        pairings_file += '\t';
+        g2.append_pid(pairings_file, it->first.second + 1);
+        pairings_file += '\t';
+        append_number(pairings_file, ((double)it->second)/1000000);
+        pairings_file += '\n';
+    }
+}
+
+/**
+ *Prints the chosen protein assignments to the pairings_file (treats each assignment as a pair of runs of
+ *"order" proteins)
+ */
+static void output_pairingsOk(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, int order,
+                              assignments_t &assignments, std::string &pairings_file) {
 
     //Writes header
-    pairings_file << ">" << g1.get_accession() << "\t" <<
-                            g1.get_first_cds() << "\t" <<
-                            g1.get_last_cds() << "\t" <<
-                            g2.get_accession() << "\t" <<
-                            g2.get_first_cds() << "\t" <<
-                            g2.get_last_cds() << "\n";
+    pairings_file += '>';
+    append_pair(pairings_file, g1, g2);
+    pairings_file += '\n';
 
     //Writes pairings
-    for (std::map<std::pair<int, int>,int>::iterator it = assignments.begin(); it != assignments.end(); ++it){
-        pairings_file << g1.get_pid(it->first.first) << "\t" <<
-                         g1.get_pid(it->first.first + 1) << "\t" <<
-                         g2.get_pid(it->first.second) << "\t" <<
-                         g2.get_pid(it->first.second + 1) << "\t" <<
-                         ((double)it->second)/1000000 << "\n";
+    for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it){
+        for (int d = 0; d < order; d++) {
+            g1.append_pid(pairings_file, it->first.first + d);
+            pairings_file += '\t';
+        }
+        for (int d = 0; d < order; d++) {
+            g2.append_pid(pairings_file, it->first.second + d);
+            pairings_file += '\t';
+        }
+        append_number(pairings_file, ((double)it->second)/1000000);
+        pairings_file += '\n';
     }
 }
 
 /**
- *Receives a vector of genomic neighborhoods and returns the number of unique proteins in them.
+ *Receives a store of genomic neighborhoods and returns the number of unique proteins in them.
+ */
+int total_protein_count(NeighborhoodStore &neighborhoods) {
+    return neighborhoods.unique_protein_count();
+}
+
+/**
+ *Receives the name of a neighborhood comparing method.
+ *Returns k if it is a porthodom Ok method ("porthodomO3", "porthodomO4", ...) and 0 otherwise.
+ */
+static int porthodomOk_order(const std::string &method) {
+    if (method.compare(0, 10, "porthodomO") != 0 || method.size() == 10 ||
+        method.find_first_not_of("0123456789", 10) != std::string::npos)
+        return 0;
+    int order = std::atoi(method.c_str() + 10);
+    return order >= 3 ? order : 0;
+}
+
+/**
+ *Receives the methods requested by the user (separated by commas).
+ *Returns the outputs of every method, without opening their files.
  */
-int total_protein_count(std::vector<GenomicNeighborhood> &neighborhoods) {
-    std::set<std::string> protein_set;
-    for(unsigned int i = 0; i < neighborhoods.size(); i++) {
-        for (GenomicNeighborhood::iterator it = neighborhoods[i].begin(); it != neighborhoods[i].end(); ++it) {
-            protein_set.emplace(it->pid);
+std::vector<method_output_t> method_outputs(const std::string &method) {
+    std::vector<std::string> methods = split(method, ",");
+    std::vector<method_output_t> outputs(methods.size());
+
+    //porthodom is solved first, so the other methods can use its result to skip pairs
+    std::stable_partition(methods.begin(), methods.end(), [](const std::string &name) {return name == "porthodom";});
+
+    for (unsigned int k = 0; k < methods.size(); k++) {
+        outputs[k].order = porthodomOk_order(methods[k]);
+        if (methods[k] != "porthodom" && methods[k] != "porthodomO2" && methods[k] != "porthodom-count" &&
+            methods[k] != "colinear" && outputs[k].order == 0) {
+            std::cerr << "ERROR: unknown neighborhood comparing method " << methods[k] << "\n";
+            exit(1);
         }
+        outputs[k].method = methods[k];
+        outputs[k].min_proteins = methods[k] == "porthodomO2" ? 2 : std::max(outputs[k].order, 1);
     }
-    return protein_set.size();
+    return outputs;
 }
 
 /**
- *Receives a vector of genomic neighborhoods,
- *a ProteinCollection and the desired genomic neighborhood clustering method.
- *Writes the similarity between all genomic neighborhoods on the genome_sim_filename and,
- *optionally, the pairings made between their proteins on the pairings_filename.
+ *Receives the methods requested by the user (separated by commas) and the output filenames.
+ *Opens the output files of every method. A single method writes to the filenames as given; with more than one
+ *method, each one writes to the filenames followed by ".<method>". If append, the files are written after what they
+ *already have.
  */
-void genome_clustering(std::vector<GenomicNeighborhood> &neighborhoods, ProteinCollection &clusters,
-                       const std::string &method, double prot_stringency, double neigh_stringency, const std::string &genome_sim_filename,
-                       const std::string &pairings_filename) {
-
-    std::ofstream output_file;
-    if(genome_sim_filename == "-")
-        output_file.basic_ios<char>::rdbuf(std::cout.rdbuf());
-    else
-        output_file = std::ofstream(genome_sim_filename.c_str());
-
-    std::ofstream pairings_file;
-    if(pairings_filename != "&") //Dummy filename indicating this option was not chosen
-        pairings_file = std::ofstream(pairings_filename.c_str());
-
-    if (method == "porthodom") {
-        std::map<std::pair<int,int>, int> assignments;
-        double score;
-        for(unsigned int m = 0; m < neighborhoods.size(); m++) {
-            for (unsigned int n = m + 1; n < neighborhoods.size(); n++) {
-                //Edges chosen by the algorithm
-                assignments = porthodom_assignments(neighborhoods[m], neighborhoods[n], clusters, prot_stringency);
-
-                //apply the scoring formula
-                score = porthodom_scoring(assignments,
-                                          std::max(neighborhoods[m].protein_count(), neighborhoods[n].protein_count()));
-
-                if (score < neigh_stringency) continue; //ignore scores below stringency
-                //Writes scores to output_file
-                output_score(neighborhoods[m], neighborhoods[n], score, output_file);
-
-                if (pairings_filename == "&") continue; //Dummy filename indicating this option was not chosen
-                //Writes pairing to pairings_file
-                output_pairings(neighborhoods[m], neighborhoods[n], assignments, pairings_file);
+std::vector<method_output_t> open_method_outputs(const std::string &method, const std::string &genome_sim_filename,
+                                                 const std::string &pairings_filename, bool append) {
+    std::vector<method_output_t> outputs = method_outputs(method);
+
+    if (outputs.size() > 1 && genome_sim_filename == "-") {
+        std::cerr << "ERROR: comparing neighborhoods with more than one method requires an output filename\n";
+        exit(1);
+    }
+
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        std::string suffix = outputs.size() > 1 ? "." + outputs[k].method : "";
+
+        std::ios::openmode mode = append ? std::ios::out | std::ios::app | std::ios::ate : std::ios::out;
+
+        if(genome_sim_filename == "-")
+            outputs[k].output_file.basic_ios<char>::rdbuf(std::cout.rdbuf());
+        else
+            outputs[k].output_file.open((genome_sim_filename + suffix).c_str(), mode);
+
+        if(pairings_filename != "&") //Dummy filename indicating this option was not chosen
+            outputs[k].pairings_file.open((pairings_filename + suffix).c_str(), mode);
+    }
+    return outputs;
+}
+
+/**
+ *Appends the results of every method for a pair of neighborhoods to the buffers of the output files (the output of
+ *the k-th method at 2k and its pairings at 2k + 1)
+ */
+static void output_results(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, std::vector<method_result_t> &results,
+                           std::vector<method_output_t> &outputs, const std::string &pairings_filename,
+                           std::vector<std::string> &buffers) {
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        if (!results[k].found) continue;
+        std::string &output_file = buffers[2*k];
+        std::string &pairings_file = buffers[2*k + 1];
+
+        //Writes scores to output_file
+        output_score(g1, g2, results[k].score, output_file);
+
+        if (pairings_filename == "&") continue; //Dummy filename indicating this option was not chosen
+        //Writes pairing to pairings_file
+        if (outputs[k].method == "porthodomO2")
+            output_pairingsO2(g1, g2, results[k].assignments, pairings_file);
+        else if (outputs[k].order > 0)
+            output_pairingsOk(g1, g2, outputs[k].order, results[k].assignments, pairings_file);
+        else
+            output_pairings(g1, g2, results[k].assignments, pairings_file);
+    }
+}
+
+/**
+ *Receives a store of genomic neighborhoods (resolved in the ProteinCollection), whether the position of the seeds
+ *matters and the first reference neighborhood (see clustering_options_t::first_reference).
+ *Returns the equivalence class of each neighborhood: neighborhoods with the same sequence of proteins
+ *(compared by their index in the ProteinCollection) have the same class, numbered in order of first appearance.
+ *Queries and references are never in the same class, so the last member of the class of a query is a query.
+ */
+static std::vector<int> neighborhood_classes(NeighborhoodStore &neighborhoods, bool with_seeds,
+                                             unsigned int first_reference) {
+    std::map<std::vector<long>, int> class_of;
+    std::vector<int> classes(neighborhoods.size());
+    std::vector<long> sequence;
+
+    for (unsigned int i = 0; i < neighborhoods.size(); i++) {
+        //proteins without similarities are all alike (-1)
+        const long *indexes = neighborhoods.protein_indexes(i);
+        sequence.assign(indexes, indexes + neighborhoods.protein_count(i));
+        if (with_seeds)
+            sequence.push_back(neighborhoods.seed_index(i));
+        if (first_reference > 0)
+            sequence.push_back(i >= first_reference);
+        classes[i] = class_of.emplace(sequence, (int)class_of.size()).first->second;
+    }
+    return classes;
+}
+
+/**
+ *Receives the proteins of the region of a group of windows and a neighborhood of the same accession.
+ *Returns the position of the first protein of the neighborhood in the region, if its proteins continue as the ones
+ *of the region (possibly past its end), or -1.
+ */
+static int region_offset(NeighborhoodStore &neighborhoods, std::vector<unsigned int> &region, unsigned int n) {
+    unsigned int first = neighborhoods.first_protein(n);
+    int count = neighborhoods.protein_count(n);
+    for (unsigned int r = 0; r < region.size(); r++) {
+        if (neighborhoods.pid_key(region[r]) != neighborhoods.pid_key(first) ||
+            neighborhoods.cds_begin(region[r]) != neighborhoods.cds_begin(first)) continue;
+
+        for (unsigned int r2 = r, p = first; r2 < region.size() && p < first + count; ++r2, ++p)
+            if (neighborhoods.pid_key(region[r2]) != neighborhoods.pid_key(p) ||
+                neighborhoods.cds_begin(region[r2]) != neighborhoods.cds_begin(p))
+                return -1;
+        return r;
+    }
+    return -1;
+}
+
+/**
+ *Receives a store of genomic neighborhoods (resolved in the ProteinCollection) and the minimum number of proteins of
+ *the compared ones.
+ *Returns the groups of overlapping windows found among them. Neighborhoods that don't overlap another one of their
+ *accession are left out.
+ */
+static std::vector<window_group_t> overlapping_windows(NeighborhoodStore &neighborhoods, int min_proteins) {
+    std::map<std::string, std::vector<unsigned int> > windows;
+    std::vector<window_group_t> groups;
+
+    for (unsigned int i = 0; i < neighborhoods.size(); i++)
+        if (neighborhoods.protein_count(i) >= std::max(min_proteins, 1))
+            windows[neighborhoods.get_accession(i)].push_back(i);
+
+    for (std::map<std::string, std::vector<unsigned int> >::iterator it = windows.begin(); it != windows.end(); ++it) {
+        std::stable_sort(it->second.begin(), it->second.end(), [&neighborhoods](unsigned int a, unsigned int b) {
+            return neighborhoods.get_first_cds(a) < neighborhoods.get_first_cds(b);
+        });
+
+        for (unsigned int w = 0; w < it->second.size(); w++) {
+            unsigned int n = it->second[w];
+            int offset = w > 0 ? region_offset(neighborhoods, groups.back().region, n) : -1;
+            if (offset < 0) { //starts a new group
+                groups.push_back(window_group_t());
+                offset = 0;
+            }
+
+            //The proteins of the window past the end of the region extend it
+            window_group_t &group = groups.back();
+            int shared = std::min((int)group.region.size() - offset, neighborhoods.protein_count(n));
+            const long *indexes = neighborhoods.protein_indexes(n);
+            for (int p = shared; p < neighborhoods.protein_count(n); p++) {
+                group.region.push_back(neighborhoods.first_protein(n) + p);
+                group.region_indexes.push_back(indexes[p]);
             }
+            group.members.push_back(n);
+            group.offsets.push_back(offset);
         }
     }
 
-    else if (method == "porthodomO2") {
-        std::map<std::pair<int,int>, int> assignments;
-        double score;
-        for(unsigned int m = 0; m < neighborhoods.size(); m++) {
+    groups.erase(std::remove_if(groups.begin(), groups.end(), [](const window_group_t &group) {
+        return group.members.size() < 2;
+    }), groups.end());
+    return groups;
+}
+
+/**
+ *Compares two genomic neighborhoods with every method, leaving the results in comparer.results.
+ *The similarities between their proteins are looked up, unless a view of them is given in region_block.
+ *If potentials is given, the solver of the k-th method starts from potentials[k] and leaves its own there.
+ */
+void compare_pair(pair_comparer_t &comparer, const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                  const SimilarityBlock *region_block, std::vector<std::vector<int> > *potentials) {
+
+    std::vector<method_output_t> &outputs = *comparer.outputs;
+    std::vector<method_result_t> &results = comparer.results;
+    assignments_t &assignments = comparer.assignments;
+    double prot_stringency = comparer.prot_stringency;
+    double neigh_stringency = comparer.neigh_stringency;
+    clustering_stats_t &stats = comparer.stats;
+    double score = 0;
+    double total_porthodom = -1; //total weight of the porthodom assignments of the pair, -1 if not solved
+    bool below_min;              //set when a solver proves the pair can't reach neigh_stringency
+    bool anchored = comparer.options.seed_anchor && g1.seed_index() >= 0 && g2.seed_index() >= 0; //see --seed_anchor
+
+    //Large pairs are solved by porthodom over the similarity graph when it is sparse enough
+    bool try_sparse = comparer.has_porthodom && !comparer.options.seed_anchor &&
+                      std::max(g1.protein_count(), g2.protein_count()) >= SPARSE_MIN_GENES;
+
+    //Similarities between the proteins, shared by all methods (porthodom alone only needs them if the pair is too dense)
+    bool lazy_block = region_block == NULL && try_sparse && outputs.size() == 1;
+    if (region_block == NULL && !lazy_block)
+        comparer.block.fill(g1, g2, *comparer.clusters);
+    const SimilarityBlock &block = region_block ? *region_block : comparer.block;
+    stats.pairs++;
+
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        results[k].found = false;
+        comparer.cold_start.clear();
+        std::vector<int> &start = potentials ? (*potentials)[k] : comparer.cold_start;
 
-            if(neighborhoods[m].protein_count() == 1) continue; //Ignores neighborhoods with less than 2 proteins
+        if (outputs[k].method == "porthodom") {
+            //Edges chosen by the algorithm
+            int length = std::max(g1.protein_count(), g2.protein_count());
+            bool sparse = try_sparse && porthodom_sparse_assignments(g1, g2, *comparer.clusters, prot_stringency,
+                                                                     neigh_stringency*length, below_min, assignments);
+            if (!sparse) {
+                if (lazy_block)
+                    comparer.block.fill(g1, g2, *comparer.clusters);
+                if (anchored)
+                    assignments = porthodom_anchored_assignments(block, g1.seed_index(), g2.seed_index(),
+                                                                 prot_stringency, neigh_stringency*length, below_min);
+                else
+                    assignments = porthodom_assignments(block, prot_stringency, neigh_stringency*length, below_min, start);
+            }
+            if (below_min) {
+                stats.early_stops++;
+                continue;
+            }
+            if (sparse)
+                stats.sparse_solves++;
+            stats.solves++;
+
+            //apply the scoring formula
+            double total = porthodom_total(assignments);
+            score = total/std::max(g1.protein_count(), g2.protein_count());
+
+            //Only a maximum-weight total bounds the order-aware methods: the anchored one is constrained
+            if (!anchored)
+                total_porthodom = total;
+        }
+
+        else if (outputs[k].method == "porthodomO2") {
+            //Ignores neighborhoods with less than 2 proteins
+            if(g1.protein_count() == 1 || g2.protein_count() == 1) continue;
+
+            int length = std::max(g1.protein_count(), g2.protein_count()) - 1;
+
+            //Skips the solve if the porthodom result (or its cheap bound) shows the score can't reach the stringency
+            if (neigh_stringency > 0) {
+                double bound = total_porthodom >= 0 ? total_porthodom : porthodom_upper_bound(block, prot_stringency);
+                if (porthodomO2_upper_bound(block, prot_stringency, bound, length) < neigh_stringency) {
+                    stats.bound_skips++;
+                    continue;
+                }
+            }
+
+            //Edges chosen by the algorithm
+            assignments = porthodomO2_assignments(block, prot_stringency, neigh_stringency*length, below_min, start);
+            if (below_min) {
+                stats.early_stops++;
+                continue;
+            }
+            stats.solves++;
+
+            //apply the scoring formula
+            score = porthodomO2_scoring(assignments, length);
+        }
+
+        else if (outputs[k].method == "porthodom-count") {
+            //Maximum number of one-to-one pairs among the proteins that reach the stringency
+            assignments = porthodom_count_assignments(block, prot_stringency);
+            stats.solves++;
+
+            //apply the scoring formula
+            score = porthodom_count_scoring(assignments, std::max(g1.protein_count(), g2.protein_count()));
+        }
+
+        else if (outputs[k].method == "colinear") {
+            //Order-preserving alignment of the proteins
+            double weight = colinear_alignment(block, prot_stringency, comparer.options.gap_penalty,
+                                               comparer.options.colinear_reverse, assignments);
 
-            for (unsigned int n = m + 1; n < neighborhoods.size(); n++) {
+            //apply the scoring formula
+            score = colinear_scoring(weight, std::max(g1.protein_count(), g2.protein_count()));
+        }
 
-                if(neighborhoods[n].protein_count() == 1) continue; //Ignores neighborhoods with less than 2 proteins
+        else if (outputs[k].order > 0) {
+            int order = outputs[k].order;
 
-                //Edges chosen by the algorithm
-                assignments = porthodomO2_assignments(neighborhoods[m], neighborhoods[n], clusters, prot_stringency);
+            //Ignores neighborhoods with less than "order" proteins
+            if(g1.protein_count() < order || g2.protein_count() < order) continue;
 
-                //apply the scoring formula
-                score = porthodomO2_scoring(assignments,
-                                          std::max(neighborhoods[m].protein_count(), neighborhoods[n].protein_count()) - 1);
+            int length = std::max(g1.protein_count(), g2.protein_count()) - order + 1;
 
-                if (score < neigh_stringency) continue; //ignore scores below stringency
-                //Writes scores to output_file
-                output_score(neighborhoods[m], neighborhoods[n], score, output_file);
+            //Skips the solve if the porthodom result (or its cheap bound) shows the score can't reach the stringency
+            if (neigh_stringency > 0) {
+                double bound = total_porthodom >= 0 ? total_porthodom : porthodom_upper_bound(block, prot_stringency);
+                if (porthodomOk_upper_bound(block, order, prot_stringency, bound, length) < neigh_stringency) {
+                    stats.bound_skips++;
+                    continue;
+                }
+            }
 
-                if (pairings_filename == "&") continue; //Dummy filename indicating this option was not chosen
-                //Writes pairing to pairings_file
-                output_pairingsO2(neighborhoods[m], neighborhoods[n], assignments, pairings_file);
+            //Edges chosen by the algorithm
+            assignments = porthodomOk_assignments(block, order, prot_stringency, neigh_stringency*length, below_min, start);
+            if (below_min) {
+                stats.early_stops++;
+                continue;
             }
+            stats.solves++;
+
+            //apply the scoring formula
+            score = porthodomOk_scoring(assignments, length);
+        }
+
+        if (score < neigh_stringency) continue; //ignore scores below stringency
+        results[k].found = true;
+        results[k].score = score;
+        results[k].assignments.swap(assignments);
+    }
+}
+
+/**
+ *Returns the results of every method for the pair of neighborhoods m and n: the ones of a pair of identical
+ *neighborhoods, if kept, or compared now (see compare_pair).
+ */
+static std::vector<method_result_t> &pair_results(pair_comparer_t &comparer, NeighborhoodStore &neighborhoods,
+                                                  unsigned int m, unsigned int n, const SimilarityBlock *region_block,
+                                                  std::vector<std::vector<int> > *potentials) {
+    result_cache_t &cache = *comparer.cache;
+    int cm = cache.classes[m], cn = cache.classes[n];
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        std::map<std::pair<int, int>, std::vector<method_result_t> >::iterator cached = cache.results.find(std::make_pair(cm, cn));
+        if (cached != cache.results.end()) {
+            comparer.stats.duplicate_pairs++;
+            return cached->second;
         }
     }
+
+    compare_pair(comparer, GenomicNeighborhood(neighborhoods, m), GenomicNeighborhood(neighborhoods, n), region_block,
+                 potentials);
+
+    //Kept only if a later pair has the same classes: a later column of this row, or one after the next row of the class
+    //of m (copied to the heap: the arena is reset after the pair)
+    unsigned int next_row = cache.next_member[m];
+    if (cache.last_member[cn] > n || (next_row != m && cache.last_member[cn] > next_row)) {
+        unsigned long long allocations = heap_allocation_count();
+        std::lock_guard<std::mutex> guard(cache.lock);
+        Arena::Scope heap(NULL);
+        if (cache.results.size() < RESULT_CACHE_MAX_PAIRS)
+            cache.results.emplace(std::make_pair(cm, cn), comparer.results);
+        comparer.stats.heap_allocations -= heap_allocation_count() - allocations;
+    }
+    return comparer.results;
+}
+
+/**
+ *Compares the pair of neighborhoods m and n (see pair_results) and appends its results to the buffers.
+ *All the memory used for the pair comes from the arena of the comparer, which is reset at the end.
+ */
+void output_pair(pair_comparer_t &comparer, NeighborhoodStore &neighborhoods, unsigned int m,
+                 unsigned int n, const SimilarityBlock *region_block, std::vector<std::vector<int> > *potentials,
+                 const std::string &pairings_filename, std::vector<std::string> &buffers) {
+    unsigned long long allocations = heap_allocation_count();
+
+    std::vector<method_result_t> &results = pair_results(comparer, neighborhoods, m, n, region_block, potentials);
+    output_results(GenomicNeighborhood(neighborhoods, m), GenomicNeighborhood(neighborhoods, n), results, *comparer.outputs,
+                   pairings_filename, buffers);
+
+    for (unsigned int k = 0; k < comparer.results.size(); k++)
+        comparer.results[k].assignments.clear();
+    comparer.assignments.clear();
+    comparer.arena.reset();
+    comparer.stats.heap_allocations += heap_allocation_count() - allocations;
+}
+
+/**
+ *Compares every window of a group with the neighborhoods after it (from columns_begin on), starting at the turn of its
+ *first window.
+ *For each neighborhood, the similarities are looked up once for the whole region and every window is compared on its
+ *rows of them, warm starting the solvers from the potentials of the previous window. The results of the first window
+ *are appended to buffers and the ones of the others to their row_buffers, written at their turn.
+ */
+static void compare_window_group(pair_comparer_t &comparer, NeighborhoodStore &neighborhoods,
+                                 window_group_t &group, unsigned int first, unsigned int columns_begin, int min_proteins,
+                                 const std::string &pairings_filename, std::vector<std::string> &buffers,
+                                 std::vector<std::vector<std::string> > &row_buffers) {
+    std::vector<method_output_t> &outputs = *comparer.outputs;
+    SimilarityBlock region_block;
+    SimilarityBlock window_block;
+    std::vector<std::vector<int> > potentials(outputs.size());
+
+    for (unsigned int n = std::max(first + 1, columns_begin); n < neighborhoods.size(); n++) {
+
+        if(neighborhoods.protein_count(n) < min_proteins) continue;
+
+        region_block.fill(group.region_indexes.data(), group.region_indexes.size(), neighborhoods.protein_indexes(n),
+                          neighborhoods.protein_count(n), *comparer.clusters);
+        comparer.stats.region_fills++;
+        for (unsigned int k = 0; k < potentials.size(); k++)
+            potentials[k].clear();
+
+        for (unsigned int w = 0; w < group.members.size(); w++) {
+            unsigned int m = group.members[w];
+            if (m >= n) continue;
+
+            window_block.view(region_block, group.offsets[w], 0, neighborhoods.protein_count(m), neighborhoods.protein_count(n));
+            output_pair(comparer, neighborhoods, m, n, &window_block, &potentials, pairings_filename,
+                        m == first ? buffers : row_buffers[m]);
+        }
+    }
+}
+
+/**
+ *Receives a pair of neighborhoods m < n among count neighborhoods.
+ *Returns the position of the pair among all the pairs of neighborhoods, in the order they are compared (its index in
+ *the upper triangle of the comparison)
+ */
+unsigned long long triangle_index(unsigned long long m, unsigned long long n, unsigned long long count) {
+    return m*(2*count - m - 1)/2 + (n - m - 1);
+}
+
+/**
+ *Receives a row of the queue.
+ *Sets begin and end to the neighborhoods it is compared with: the columns of the queue after it whose pairs are in the
+ *triangle indexes of the queue (none for the rows from queue.rows_end on)
+ */
+void row_columns(row_queue_t &queue, unsigned int m, unsigned int &begin, unsigned int &end) {
+    unsigned long long count = queue.neighborhoods->size();
+    unsigned long long row_first = triangle_index(m, m + 1, count);
+    unsigned long long first = m + 1 + std::min(std::max(queue.pairs_begin, row_first) - row_first, count);
+    unsigned long long last = m + 1 + std::min(std::max(queue.pairs_end, row_first) - row_first, count);
+    begin = std::max((unsigned long long)std::max(m + 1, queue.columns_begin), std::min(first, count));
+    end = m < queue.rows_end ? std::min((unsigned long long)queue.columns_end, last) : 0;
+}
+
+/**
+ *Set by SIGTERM while genome_clustering saves checkpoints: the threads stop taking rows
+ */
+std::atomic<bool> termination_requested(false);
+
+void request_termination(int) {
+    termination_requested = true;
+}
+
+/**
+ *Takes rows from the queue until there are none left, comparing them with the comparer of the thread
+ */
+static void compare_rows(pair_comparer_t &comparer, row_queue_t &queue) {
+    NeighborhoodStore &neighborhoods = *queue.neighborhoods;
+    std::vector<method_output_t> &outputs = *queue.outputs;
+    result_cache_t &cache = *comparer.cache;
+    std::vector<std::string> buffers(2*outputs.size());
+    Arena::Scope scope(&comparer.arena);
+
+    //A run stopped by SIGTERM finishes the rows already taken, so the rows written are still the first ones
+    while (!termination_requested) {
+        unsigned int r = queue.next++;
+        if (r >= queue.rows.size()) break;
+        unsigned int m = queue.rows[r];
+        int group = queue.group_of[m];
+        bool buffered = !queue.row_buffers[m].empty(); //compared with the first window of its group
+
+        if (group >= 0 && !buffered)
+            compare_window_group(comparer, neighborhoods, queue.groups[group], m, queue.columns_begin, queue.min_proteins,
+                                 queue.pairings_filename, buffers, queue.row_buffers);
+
+        else if (!buffered) {
+            unsigned int columns_begin, columns_end;
+            row_columns(queue, m, columns_begin, columns_end);
+            for (unsigned int n = columns_begin; n < columns_end; n++) {
+
+                if(neighborhoods.protein_count(n) < queue.min_proteins) continue;
+
+                output_pair(comparer, neighborhoods, m, n, NULL, NULL, queue.pairings_filename, buffers);
+            }
+        }
+
+        //Waits for the previous rows to be written
+        std::unique_lock<std::mutex> guard(queue.lock);
+        queue.turn.wait(guard, [&queue, r]() {return queue.written == r;});
+
+        std::vector<std::string> &row = buffered ? queue.row_buffers[m] : buffers;
+        for (unsigned int k = 0; k < outputs.size(); k++) {
+            outputs[k].output_file << row[2*k];
+            outputs[k].pairings_file << row[2*k + 1];
+            row[2*k].clear();
+            row[2*k + 1].clear();
+        }
+        if (buffered)
+            std::vector<std::string>().swap(row);
+
+        //No later pair can use the results of this class anymore
+        int cm = cache.classes[m];
+        if (cache.last_member[cm] == m) {
+            std::lock_guard<std::mutex> cache_guard(cache.lock);
+            cache.results.erase(cache.results.lower_bound(std::make_pair(cm, 0)),
+                                cache.results.lower_bound(std::make_pair(cm + 1, 0)));
+        }
+
+        queue.written++;
+        if (queue.checkpoint && std::chrono::steady_clock::now() - queue.checkpoint->last >=
+                                std::chrono::seconds(queue.checkpoint->interval))
+            write_checkpoint(queue);
+        queue.turn.notify_all();
+    }
+}
+
+/**
+ *Prints the statistics of a genome_clustering run
+ */
+void print_stats(clustering_stats_t &stats) {
+    std::cerr << "Pairs of neighborhoods compared: " << stats.pairs << "\n"
+              << "Pairs answered from identical neighborhoods: " << stats.duplicate_pairs << "\n"
+              << "Similarity blocks filled for regions of overlapping windows: " << stats.region_fills << "\n"
+              << "Assignment problems solved: " << stats.solves << "\n"
+              << "porthodom problems solved by the sparse solver: " << stats.sparse_solves << "\n"
+              << "Solves stopped early below the neighborhood stringency: " << stats.early_stops << "\n"
+              << "Order-aware (porthodomO2/Ok) solves skipped by the porthodom bound: " << stats.bound_skips << "\n"
+              << "Heap allocations while comparing pairs: " << stats.heap_allocations << "\n";
+}
+
+/**
+ *Adds the statistics of a thread to the ones of the run
+ */
+void add_stats(clustering_stats_t &total, const clustering_stats_t &stats) {
+    total.pairs += stats.pairs;
+    total.duplicate_pairs += stats.duplicate_pairs;
+    total.region_fills += stats.region_fills;
+    total.solves += stats.solves;
+    total.sparse_solves += stats.sparse_solves;
+    total.early_stops += stats.early_stops;
+    total.bound_skips += stats.bound_skips;
+    total.heap_allocations += stats.heap_allocations;
+}
+
+/**
+ *Receives the outputs of the requested methods.
+ *Returns the minimum number of proteins of the neighborhoods compared by any of them, and sets has_porthodom if
+ *porthodom is one of them.
+ */
+int min_method_proteins(std::vector<method_output_t> &outputs, bool &has_porthodom) {
+    int min_proteins = outputs[0].min_proteins;
+    has_porthodom = false;
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        min_proteins = std::min(min_proteins, outputs[k].min_proteins);
+        has_porthodom = has_porthodom || outputs[k].method == "porthodom";
+    }
+    return min_proteins;
+}
+
+/**
+ *Receives a store of genomic neighborhoods, with their proteins resolved to ids shared by all of them, and fills the
+ *classes of identical neighborhoods of the cache (see neighborhood_classes) and their last and next members.
+ */
+void fill_result_cache(result_cache_t &cache, NeighborhoodStore &neighborhoods, bool with_seeds,
+                       unsigned int first_reference) {
+    cache.classes = neighborhood_classes(neighborhoods, with_seeds, first_reference);
+    cache.last_member.resize(neighborhoods.size());
+    for (unsigned int i = 0; i < neighborhoods.size(); i++)
+        cache.last_member[cache.classes[i]] = i;
+
+    std::vector<unsigned int> following(neighborhoods.size(), 0); //member of each class after the current one, 0 for none
+    cache.next_member.resize(neighborhoods.size());
+    for (unsigned int i = neighborhoods.size(); i > 0; i--) {
+        int c = cache.classes[i - 1];
+        cache.next_member[i - 1] = following[c] > i - 1 ? following[c] : i - 1;
+        following[c] = i - 1;
+    }
+}
+
+/**
+ *Creates a comparer for each thread, sharing the outputs, the ProteinCollection and the result cache
+ */
+void init_comparers(std::vector<pair_comparer_t> &comparers, std::vector<method_output_t> &outputs,
+                    ProteinCollection *clusters, double prot_stringency, double neigh_stringency,
+                    const clustering_options_t &options, bool has_porthodom, result_cache_t &cache) {
+    for (unsigned int t = 0; t < comparers.size(); t++) {
+        pair_comparer_t &comparer = comparers[t];
+        comparer.outputs = &outputs;
+        comparer.clusters = clusters;
+        comparer.prot_stringency = prot_stringency;
+        comparer.neigh_stringency = neigh_stringency;
+        comparer.options = options;
+        comparer.has_porthodom = has_porthodom;
+        comparer.cache = &cache;
+        comparer.results.resize(outputs.size());
+        comparer.stats = clustering_stats_t();
+    }
+}
+
+/**
+ *Compares the rows of the queue, from the first one, with a thread for each comparer
+ */
+void compare_queue(std::vector<pair_comparer_t> &comparers, row_queue_t &queue) {
+    queue.next = 0;
+    queue.written = 0;
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < comparers.size(); t++)
+        workers.push_back(std::thread(compare_rows, std::ref(comparers[t]), std::ref(queue)));
+    compare_rows(comparers[0], queue);
+    for (unsigned int t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+/**
+ *Prints the statistics of the comparers of a genome_clustering run
+ */
+void print_comparer_stats(std::vector<pair_comparer_t> &comparers) {
+    clustering_stats_t stats = clustering_stats_t();
+    for (unsigned int t = 0; t < comparers.size(); t++)
+        add_stats(stats, comparers[t].stats);
+    print_stats(stats);
+}
+
+/**
+ *Compares the pairs of a batch, taken in any order by the threads, appending the results of the i-th pair to
+ *results[i] (see output_pair)
+ */
+static void compare_batch(pair_comparer_t &comparer, NeighborhoodStore &neighborhoods,
+                          const std::pair<unsigned int, unsigned int> *batch, size_t size, std::atomic<size_t> &next,
+                          const std::string &pairings_filename, std::vector<std::vector<std::string> > &results) {
+    Arena::Scope scope(&comparer.arena);
+    for (size_t i = next++; i < size; i = next++)
+        output_pair(comparer, neighborhoods, batch[i].first, batch[i].second, NULL, NULL, pairings_filename, results[i]);
+}
+
+/**
+ *Compares the pairs of a batch with a thread for each comparer, leaving the results of the i-th pair in results[i]
+ */
+void compare_pairs(std::vector<pair_comparer_t> &comparers, NeighborhoodStore &neighborhoods,
+                   const std::pair<unsigned int, unsigned int> *batch, size_t size,
+                   const std::string &pairings_filename, std::vector<std::vector<std::string> > &results) {
+    results.assign(size, std::vector<std::string>(2*comparers[0].outputs->size()));
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < comparers.size() && t < size; t++)
+        workers.push_back(std::thread(compare_batch, std::ref(comparers[t]), std::ref(neighborhoods), batch, size,
+                                      std::ref(next), std::cref(pairings_filename), std::ref(results)));
+    compare_batch(comparers[0], neighborhoods, batch, size, next, pairings_filename, results);
+    for (unsigned int t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+/**
+ *Receives a store of genomic neighborhoods, the minimum number of proteins of the compared ones, the first
+ *neighborhood compared as the second one of a pair (see clustering_options_t::first_new), the end of the ones
+ *compared as the first one (see clustering_options_t::first_reference) and a number of parts.
+ *Returns the triangle indexes where each part of the pairs begins, followed by the end of the last one. The pairs are
+ *split in the order they are compared into parts of about the same estimated cost, the product of the protein counts
+ *of the two neighborhoods.
+ */
+std::vector<unsigned long long> split_pairs(NeighborhoodStore &neighborhoods, int min_proteins,
+                                            unsigned int first_column, unsigned int rows_end, int parts) {
+    unsigned int count = neighborhoods.size();
+    std::vector<unsigned long long> proteins(count);     //0 for the neighborhoods that are not compared
+    std::vector<unsigned long long> proteins_after(count + 1, 0);
+    for (unsigned int n = 0; n < count; n++)
+        proteins[n] = neighborhoods.protein_count(n) >= min_proteins ? neighborhoods.protein_count(n) : 0;
+    for (unsigned int n = count; n > 0; n--)
+        proteins_after[n - 1] = proteins_after[n] + proteins[n - 1];
+
+    //Pairs with a second neighborhood before first_column or a first one from rows_end on are not compared
+    std::vector<unsigned long long> row_costs(count, 0);
+    unsigned long long total = 0;
+    for (unsigned int m = 0; m < std::min(rows_end, count); m++) {
+        row_costs[m] = proteins[m]*proteins_after[std::max(m + 1, std::min(first_column, count))];
+        total += row_costs[m];
+    }
+
+    //Each part ends after the first pair at which the cost of the pairs up to it reaches its share
+    std::vector<unsigned long long> begins(1, 0);
+    unsigned int m = 0;
+    unsigned long long cost = 0; //of the rows before m
+    for (int k = 1; k < parts; k++) {
+        unsigned long long target = (unsigned long long)((long double)total*k/parts);
+        for (; m < count && cost + row_costs[m] < target; m++)
+            cost += row_costs[m];
+
+        unsigned long long end = (unsigned long long)count*(count - (count > 0))/2, row_cost = cost;
+        for (unsigned int n = std::max(m + 1, first_column); n < count; n++) {
+            row_cost += proteins[m]*proteins[n];
+            if (row_cost >= target) {
+                end = triangle_index(m, n, count) + 1;
+                break;
+            }
+        }
+        begins.push_back(end);
+    }
+    begins.push_back((unsigned long long)count*(count - (count > 0))/2);
+    return begins;
+}
+
+/**
+ *Receives a store of genomic neighborhoods,
+ *a ProteinCollection and the desired genomic neighborhood clustering methods (separated by commas).
+ *Writes the similarity between all genomic neighborhoods on the genome_sim_filename and,
+ *optionally, the pairings made between their proteins on the pairings_filename.
+ *The similarities between the proteins of each pair of neighborhoods are looked up only once and shared by all methods.
+ *Neighborhoods with identical protein sequences are compared only once; their results are written for every pair.
+ *With a seed window, the neighborhoods are restricted to it (see NeighborhoodStore::set_seed_window).
+ *The rows of the comparison are split among options.threads threads; the output is the same for any number of them.
+ *With more than one shard, only the pairs of options.shard are compared (see split_pairs), without overlapping windows.
+ *With options.first_new, only the pairs with a new neighborhood are compared, and appended to the outputs.
+ *With options.first_reference, the rows are the queries and the columns the references: only the rectangle of their
+ *pairs is compared, split among the threads, shards and ranks as the triangle is.
+ */
+void genome_clustering(NeighborhoodStore &neighborhoods, ProteinCollection &clusters,
+                       const std::string &method, double prot_stringency, double neigh_stringency, const std::string &genome_sim_filename,
+                       const std::string &pairings_filename, const clustering_options_t &options) {
+#ifdef USE_MPI
+    int ranks;
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    if (ranks > 1) {
+        genome_clustering_mpi(neighborhoods, clusters, method, prot_stringency, neigh_stringency, genome_sim_filename,
+                              pairings_filename, options);
+        return;
+    }
+#endif
+
+    //The checkpoint is only valid for the same neighborhoods, similarities and settings
+    checkpoint_t checkpoint;
+    unsigned int resume_row = 0;
+    bool checkpoints = options.checkpoint_interval > 0 || options.resume;
+    if (checkpoints) {
+        if (genome_sim_filename == "-") {
+            std::cerr << "ERROR: checkpoints require an output filename\n";
+            exit(1);
+        }
+        std::ostringstream settings;
+        settings << std::setprecision(17) << method << " " << prot_stringency << " " << neigh_stringency << " "
+                 << (pairings_filename != "&") << " " << options.gap_penalty << " " << options.colinear_reverse << " "
+                 << options.overlapping_windows << " " << options.seed_window << " " << options.seed_anchor << " "
+                 << options.shard << " " << options.shards << " " << options.first_new << " " << options.first_reference;
+        checkpoint.filename = genome_sim_filename + ".ckpt";
+        checkpoint.fingerprint = run_fingerprint(neighborhoods, clusters, settings.str());
+        checkpoint.interval = options.checkpoint_interval;
+        checkpoint.last = std::chrono::steady_clock::now();
+
+        std::vector<method_output_t> methods = method_outputs(method);
+        for (unsigned int k = 0; k < methods.size(); k++) {
+            std::string suffix = methods.size() > 1 ? "." + methods[k].method : "";
+            checkpoint.files.push_back(genome_sim_filename + suffix);
+            checkpoint.files.push_back(pairings_filename != "&" ? pairings_filename + suffix : "");
+        }
+        if (options.resume)
+            resume_row = read_checkpoint(checkpoint, methods);
+        std::signal(SIGTERM, request_termination);
+    }
+
+    //An incremental run adds the new pairs to the outputs of the previous one
+    std::vector<method_output_t> outputs = open_method_outputs(method, genome_sim_filename, pairings_filename,
+                                                               resume_row > 0 || options.first_new > 0);
+
+    //Neighborhoods too small for all the methods are skipped before filling their similarity blocks
+    bool has_porthodom;
+    int min_proteins = min_method_proteins(outputs, has_porthodom);
+
+    //The neighborhoods are compared on the window around their seeds
+    if (options.seed_window >= 0)
+        neighborhoods.set_seed_window(options.seed_window);
+
+    //The proteins are looked up in the ProteinCollection once, before comparing
+    neighborhoods.resolve(clusters);
+
+    result_cache_t cache;
+    fill_result_cache(cache, neighborhoods, options.seed_anchor, options.first_reference);
+
+    //A rectangular run compares the queries (rows) with the references (columns) only
+    unsigned int rows_end = options.first_reference > 0 ? options.first_reference : neighborhoods.size();
+    unsigned int first_column = std::max(options.first_new, options.first_reference);
+
+    row_queue_t queue;
+    queue.neighborhoods = &neighborhoods;
+    queue.outputs = &outputs;
+    queue.pairings_filename = pairings_filename;
+    queue.min_proteins = min_proteins;
+    queue.group_of.assign(neighborhoods.size(), -1);
+    queue.row_buffers.resize(neighborhoods.size());
+    queue.pairs_begin = 0;
+    queue.pairs_end = ~0ULL;
+    queue.checkpoint = options.checkpoint_interval > 0 ? &checkpoint : NULL;
+    if (options.shards > 1) {
+        std::vector<unsigned long long> shards = split_pairs(neighborhoods, min_proteins, first_column, rows_end,
+                                                             options.shards);
+        queue.pairs_begin = shards[options.shard];
+        queue.pairs_end = shards[options.shard + 1];
+        std::cerr << "Shard " << options.shard << "/" << options.shards << ": pairs " << queue.pairs_begin << " to "
+                  << queue.pairs_end << " of " << shards.back() << "\n";
+    }
+    else if (options.overlapping_windows)
+        queue.groups = overlapping_windows(neighborhoods, min_proteins);
+    for (unsigned int g = 0; g < queue.groups.size(); g++) {
+        std::vector<unsigned int> &members = queue.groups[g].members;
+        unsigned int first = *std::min_element(members.begin(), members.end());
+        for (unsigned int w = 0; w < members.size(); w++) {
+            if (first < resume_row) continue; //compared before the checkpoint: the rest of its windows are compared alone
+            queue.group_of[members[w]] = g;
+            if (members[w] != first)
+                queue.row_buffers[members[w]].resize(2*outputs.size());
+        }
+    }
+    queue.rows_end = rows_end;
+    queue.columns_begin = first_column;
+    queue.columns_end = neighborhoods.size();
+    for (unsigned int m = resume_row; m < rows_end; m++) {
+        unsigned int columns_begin, columns_end;
+        row_columns(queue, m, columns_begin, columns_end);
+        if (neighborhoods.protein_count(m) >= min_proteins && columns_begin < columns_end)
+            queue.rows.push_back(m);
+    }
+
+    std::vector<pair_comparer_t> comparers(std::max(options.threads, 1));
+    init_comparers(comparers, outputs, &clusters, prot_stringency, neigh_stringency, options, has_porthodom, cache);
+    compare_queue(comparers, queue);
+
+    if (checkpoints && queue.written < queue.rows.size()) { //stopped by SIGTERM
+        queue.checkpoint = &checkpoint;
+        write_checkpoint(queue);
+        std::cerr << "Stopped by SIGTERM: run again with --resume to continue from " << checkpoint.filename << "\n";
+        exit(1);
+    }
+    if (checkpoints)
+        std::remove(checkpoint.filename.c_str());
+    print_comparer_stats(comparers);
 }
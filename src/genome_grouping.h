@@ -5,30 +5,199 @@
 #include <string>
 #include <cstdlib>
 #include <set>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <iterator>
+#include <unordered_map>
+#include <memory>
+#include <deque>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <csignal>
+#include <chrono>
+#include <iomanip>
+#include "Arena.h"
+#include "NeighborhoodStore.h"
 #include "GenomicNeighborhood.h"
 #include "ProteinCollection.h"
 #include "porthodom_scoring.h"
 #include "porthodomO2_scoring.h"
+#include "porthodomOk_scoring.h"
+#include "colinear_scoring.h"
+#include "porthodom_count_scoring.h"
+#include "SimilarityBlock.h"
+#include "CompiledGraph.h"
+#include "NeighborhoodIndex.h"
+#include "protein_grouping.h"
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#define BLOCK_PROTEIN_BYTES 160   //estimated memory of each protein of a resident block (genome_clustering_blocked)...
+#define BLOCK_SIMILARITY_BYTES 32 //...and of each of its similarities
+#define TILES_PER_WORKER 16       //tiles of the pairs handed out for each worker rank (genome_clustering_mpi)
+#define UPDATE_BATCH_PAIRS 4096   //pairs compared by the threads before their results are patched in (genome_clustering_update)
+#define RESULT_CACHE_MAX_PAIRS 100000 //results kept at a time for pairs of identical neighborhoods (result_cache_t)
+#define SERVE_POLL_MS 1000        //between the checks for termination and for a changed similarities file (genome_clustering_serve)
+
+/**
+ *Statistics of a genome_clustering run, reported at the end of it
+ */
+typedef struct {
+    unsigned long long pairs;       //pairs of neighborhoods compared
+    unsigned long long duplicate_pairs; //pairs answered from the results of identical neighborhoods (not in pairs)
+    unsigned long long region_fills; //similarity blocks filled for the regions of overlapping windows
+    unsigned long long solves;      //assignment problems solved
+    unsigned long long sparse_solves; //porthodom problems solved by the sparse solver (included in solves)
+    unsigned long long early_stops; //solves stopped early because the solver's dual bound is below neigh_stringency
+    unsigned long long bound_skips; //porthodomO2/Ok solves skipped because the porthodom bound is below neigh_stringency
+    unsigned long long heap_allocations; //heap allocations made while comparing pairs and formatting their results (see heap_allocation_count)
+} clustering_stats_t;
 
 /**
- *Receives a vector of genomic neighborhoods,
- *a ProteinCollection and the desired genomic neighborhood clustering method.
+ *Options of the neighborhood comparing methods that are not shared by all of them
+ */
+typedef struct {
+    double gap_penalty;    //colinear: penalty of each protein left unpaired inside the alignment
+    bool colinear_reverse; //colinear: also aligns the second neighborhood in reverse order, keeping the best one
+    bool overlapping_windows; //compares overlapping neighborhoods of the same accession together
+    int seed_window;          //restricts the neighborhoods to this many proteins on each side of their seeds, -1 for no restriction
+    bool seed_anchor;         //porthodom: pairs the seeds and solves the proteins on each side of them separately
+    int threads;              //threads comparing neighborhoods
+    size_t memory_budget;     //bytes for the similarities of the blocks of genome_clustering_blocked
+    int shard;                //compares only the pairs of this shard (0 to shards - 1)
+    int shards;               //number of shards the pairs of neighborhoods are split into
+    int checkpoint_interval;  //seconds between the checkpoints of genome_clustering, 0 for no checkpoints
+    bool resume;              //genome_clustering continues from the checkpoint of its output, if there is one
+    unsigned int first_new;   //incremental: only the pairs with a neighborhood from this one on are compared and
+                              //appended to the outputs, 0 to compare all of them
+    unsigned int first_reference; //rectangular: the neighborhoods from this one on are the references, compared only
+                                  //with the ones before it (the queries), 0 to compare all the pairs
+} clustering_options_t;
+
+/**
+ *Receives a store of genomic neighborhoods,
+ *a ProteinCollection and the desired genomic neighborhood clustering methods (separated by commas).
  *Writes the similarity between all genomic neighborhoods on the genome_sim_filename and,
  *optionally, the pairings made between their proteins on the pairings_filename.
+ *With options.checkpoint_interval, the last consistent point of the outputs is saved to genome_sim_filename followed
+ *by ".ckpt" as the run goes (and when it gets SIGTERM), so that a later run with options.resume continues from it.
+ *With options.first_reference, only the pairs of a query and a reference are compared, the query first.
  */
-void genome_clustering(std::vector<GenomicNeighborhood> &neighborhoods, ProteinCollection &clusters,
+void genome_clustering(NeighborhoodStore &neighborhoods, ProteinCollection &clusters,
                        const std::string &method, double prot_stringency, double neigh_stringency,
-                       const std::string &genome_sim_filename, const std::string &pairings_filename);
+                       const std::string &genome_sim_filename, const std::string &pairings_filename,
+                       const clustering_options_t &options);
+
+/**
+ *Receives a store of genomic neighborhoods, a compiled similarity graph, whether its similarities are normalized
+ *and the desired genomic neighborhood clustering methods (separated by commas).
+ *Writes the same scores and pairings as genome_clustering (grouped by blocks of neighborhoods), loading only the
+ *similarities of two blocks of neighborhoods at a time, so they fit in options.memory_budget.
+ */
+void genome_clustering_blocked(NeighborhoodStore &neighborhoods, const CompiledGraph &graph, bool normalize,
+                               const std::string &method, double prot_stringency, double neigh_stringency,
+                               const std::string &genome_sim_filename, const std::string &pairings_filename,
+                               const clustering_options_t &options);
+
+/**
+ *Receives a store of genomic neighborhoods, the compiled graphs of the similarities of previous outputs and of new
+ *similarities, whether the similarities are normalized and the genomic neighborhood clustering methods of the outputs
+ *(separated by commas).
+ *Compares again only the pairs of neighborhoods with a similarity between their proteins that changed, and patches
+ *their results into the outputs (genome_sim_filename and pairings_filename, written by genome_clustering with the
+ *same settings), copying the rest of them.
+ */
+void genome_clustering_update(NeighborhoodStore &neighborhoods, const CompiledGraph &previous_graph,
+                              const CompiledGraph &graph, bool normalize, const std::string &method,
+                              double prot_stringency, double neigh_stringency, const std::string &genome_sim_filename,
+                              const std::string &pairings_filename, const clustering_options_t &options);
+
+/**
+ *Receives a stream of genomic neighborhoods (in the format of the neighborhoods file), a ProteinCollection and the
+ *desired genomic neighborhood clustering methods (separated by commas).
+ *Writes the same scores and pairings as genome_clustering, comparing each neighborhood with the previous ones as soon
+ *as it has been read and flushing their results to the outputs.
+ */
+void genome_clustering_stream(std::istream &input, ProteinCollection &clusters, const std::string &method,
+                              double prot_stringency, double neigh_stringency, const std::string &genome_sim_filename,
+                              const std::string &pairings_filename, const clustering_options_t &options);
+
+/**
+ *Receives a store of genomic neighborhoods, a protein similarities file (compiled or in text), whether its
+ *similarities are normalized, the desired genomic neighborhood clustering methods (separated by commas) and the
+ *filename of a Unix domain socket.
+ *Answers requests to score neighborhoods, sent to the socket, with a thread for each of options.threads, until
+ *SIGTERM or SIGINT. The similarities are read again when the file changes.
+ */
+void genome_clustering_serve(NeighborhoodStore &neighborhoods, const std::string &prot_sim_filename, bool normalize,
+                             const std::string &method, double prot_stringency, double neigh_stringency,
+                             const std::string &socket_filename, const clustering_options_t &options);
+
+/**
+ *Receives a store of query genomic neighborhoods, the index of a collection of neighborhoods, the compiled graph of
+ *the protein similarities it was built from, whether the similarities are normalized, the desired genomic
+ *neighborhood clustering methods (separated by commas) and the number of partners written for each query (0 for all).
+ *Writes the best partners of each query in the collection to genome_sim_filename, best first by the first method,
+ *as lines of the output files (preceded by the name of the method if there are more than one).
+ */
+void genome_clustering_query(NeighborhoodStore &queries, const NeighborhoodIndex &index, const CompiledGraph &graph,
+                             bool normalize, const std::string &method, double prot_stringency, double neigh_stringency,
+                             int top, const std::string &genome_sim_filename, const clustering_options_t &options);
+
+#ifdef USE_MPI
+/**
+ *Same as genome_clustering, with the pairs of neighborhoods compared by the other ranks of MPI_COMM_WORLD: rank 0
+ *hands out tiles of the pairs as they ask for them and writes their results in order, so the output is the same.
+ *Called by genome_clustering when there is more than one rank, on every rank; clusters is only read by the workers.
+ */
+void genome_clustering_mpi(NeighborhoodStore &neighborhoods, ProteinCollection &clusters,
+                           const std::string &method, double prot_stringency, double neigh_stringency,
+                           const std::string &genome_sim_filename, const std::string &pairings_filename,
+                           const clustering_options_t &options);
+#endif
+
+/**
+ *Receives an output filename and a shard.
+ *Returns the filename written by that shard
+ */
+std::string shard_filename(const std::string &filename, int shard);
+
+/**
+ *Receives the desired genomic neighborhood clustering methods (separated by commas), the output filenames and the
+ *number of shards written to them.
+ *Writes the outputs of all the shards to the output filenames, as written by a single run
+ */
+void merge_shards(const std::string &method, const std::string &genome_sim_filename,
+                  const std::string &pairings_filename, int shards);
 
 /**
  *Receives a genomic neighborhood filename
- *Returns a vector of genomic neighborhoods, filled with the information from the file
+ *Returns a store of genomic neighborhoods, filled with the information from the file
+ */
+NeighborhoodStore parse_neighborhoods(const std::string &neighborhoods_filename);
+
+/**
+ *Receives a store of genomic neighborhoods and the filename of the neighborhoods a previous run compared.
+ *Returns the number of those neighborhoods, which must be the first ones of the store (the others are new)
+ */
+unsigned int previous_neighborhoods(NeighborhoodStore &neighborhoods, const std::string &previous_filename);
+
+/**
+ *Receives a store of genomic neighborhoods (the queries) and the filename of reference neighborhoods.
+ *Adds the references to the store, after the queries, and returns the first of them (see
+ *clustering_options_t::first_reference)
  */
-std::vector<GenomicNeighborhood> parse_neighborhoods(const std::string &neighborhoods_filename);
+unsigned int reference_neighborhoods(NeighborhoodStore &neighborhoods, const std::string &reference_filename);
 
 /**
- *Receives a vector of genomic neighborhoods and returns the number of unique proteins in them.
+ *Receives a store of genomic neighborhoods and returns the number of unique proteins in them.
  */
-int total_protein_count(std::vector<GenomicNeighborhood> &neighborhoods);
+int total_protein_count(NeighborhoodStore &neighborhoods);
 
 #endif
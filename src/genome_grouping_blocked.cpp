@@ -0,0 +1,217 @@
+#include "genome_grouping_common.h"
+#include <sys/resource.h>
+
+/**
+ *Receives a store of genomic neighborhoods resolved in the compiled graph.
+ *Returns the estimated memory (bytes) taken by neighborhood n while its block is resident: its proteins and their
+ *similarities, copied from the graph and in the ProteinCollection of the pairs of blocks.
+ */
+static size_t neighborhood_bytes(NeighborhoodStore &neighborhoods, const CompiledGraph &graph, unsigned int n) {
+    size_t bytes = 0;
+    const long *ids = neighborhoods.protein_indexes(n);
+    for (int i = 0; i < neighborhoods.protein_count(n); i++)
+        bytes += BLOCK_PROTEIN_BYTES + (ids[i] >= 0 ? BLOCK_SIMILARITY_BYTES*graph.degree(ids[i]) : 0);
+    return bytes;
+}
+
+/**
+ *Receives a store of genomic neighborhoods, the compiled graph and the memory budget (bytes).
+ *Returns the first neighborhood of each block, followed by the end of the last one: consecutive neighborhoods
+ *are put together while two blocks fit in the budget (a neighborhood larger than that has its own block).
+ */
+static std::vector<unsigned int> split_blocks(NeighborhoodStore &neighborhoods, const CompiledGraph &graph,
+                                              size_t memory_budget) {
+    std::vector<unsigned int> blocks(1, 0);
+    size_t block_bytes = 0;
+
+    neighborhoods.resolve(graph, 0, neighborhoods.size());
+    for (unsigned int n = 0; n < neighborhoods.size(); n++) {
+        size_t bytes = neighborhood_bytes(neighborhoods, graph, n);
+        if (block_bytes > 0 && block_bytes + bytes > memory_budget/2) {
+            blocks.push_back(n);
+            block_bytes = 0;
+        }
+        block_bytes += bytes;
+    }
+    if (neighborhoods.size() > 0)
+        blocks.push_back(neighborhoods.size());
+    return blocks;
+}
+
+/**
+ *Receives the compiled graph and a block with the graph ids of its proteins.
+ *Loads the similarities of those proteins to the proteins of smaller or equal id, sorting the ids first.
+ *Returns the number of bytes of similarities read from the graph.
+ */
+size_t load_block_ids(const CompiledGraph &graph, graph_block_t &block) {
+    std::sort(block.ids.begin(), block.ids.end());
+    block.ids.erase(std::unique(block.ids.begin(), block.ids.end()), block.ids.end());
+
+    block.offsets.assign(1, 0);
+    block.neighbors.clear();
+    block.weights.clear();
+    for (unsigned int k = 0; k < block.ids.size(); k++) {
+        long id = block.ids[k];
+        const unsigned int *neighbors = graph.neighbors_of(id);
+        const double *weights = graph.weights_of(id);
+        long lower = std::upper_bound(neighbors, neighbors + graph.degree(id), (unsigned int)id) - neighbors;
+        block.neighbors.insert(block.neighbors.end(), neighbors, neighbors + lower);
+        block.weights.insert(block.weights.end(), weights, weights + lower);
+        block.offsets.push_back(block.neighbors.size());
+    }
+    return block.neighbors.size()*(sizeof(unsigned int) + sizeof(double)) +
+           block.ids.size()*2*sizeof(unsigned long long);
+}
+
+/**
+ *Receives a store of genomic neighborhoods, the compiled graph and a range of neighborhoods.
+ *Loads the block of those neighborhoods: the similarities of their proteins to the proteins of smaller or equal id.
+ *Returns the number of bytes of similarities read from the graph.
+ */
+static size_t load_block(NeighborhoodStore &neighborhoods, const CompiledGraph &graph, unsigned int first,
+                         unsigned int last, graph_block_t &block) {
+    block.first = first;
+    block.last = last;
+    block.ids.clear();
+    neighborhoods.resolve(graph, first, last);
+    for (unsigned int n = first; n < last; n++) {
+        const long *ids = neighborhoods.protein_indexes(n);
+        for (int i = 0; i < neighborhoods.protein_count(n); i++)
+            if (ids[i] >= 0)
+                block.ids.push_back(ids[i]);
+    }
+    return load_block_ids(graph, block);
+}
+
+/**
+ *Receives a compiled graph and two resident blocks.
+ *Returns the ProteinCollection with the proteins of both blocks and the similarities among them, normalized by the
+ *largest similarity of the whole graph if asked to.
+ */
+ProteinCollection block_pair_collection(const CompiledGraph &graph, graph_block_t &block1, graph_block_t &block2,
+                                        bool normalize) {
+    std::vector<long> ids;
+    std::set_union(block1.ids.begin(), block1.ids.end(), block2.ids.begin(), block2.ids.end(), std::back_inserter(ids));
+
+    //The index of each protein in the collection is its position in ids
+    ProteinCollection clusters(ids.size());
+    for (unsigned int k = 0; k < ids.size(); k++)
+        clusters.add_protein(graph.name(ids[k]));
+
+    for (unsigned int k = 0; k < ids.size(); k++) {
+        graph_block_t *block = &block1;
+        std::vector<long>::iterator found = std::lower_bound(block->ids.begin(), block->ids.end(), ids[k]);
+        if (found == block->ids.end() || *found != ids[k]) {
+            block = &block2;
+            found = std::lower_bound(block->ids.begin(), block->ids.end(), ids[k]);
+        }
+        unsigned int position = found - block->ids.begin();
+        for (unsigned long long e = block->offsets[position]; e < block->offsets[position + 1]; e++) {
+            std::vector<long>::iterator other = std::lower_bound(ids.begin(), ids.end(), (long)block->neighbors[e]);
+            if (other != ids.end() && *other == block->neighbors[e])
+                clusters.connect_proteins(k, other - ids.begin(), block->weights[e]);
+        }
+    }
+    if (normalize)
+        clusters.normalize(graph.max_similarity());
+    return clusters;
+}
+
+/**
+ *Returns the peak memory of the process so far, in MB
+ */
+static long peak_memory_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss/1024;
+}
+
+/**
+ *Receives a store of genomic neighborhoods, a compiled similarity graph (see CompiledGraph), whether its similarities
+ *are normalized and the desired genomic neighborhood clustering methods (separated by commas).
+ *Writes the same scores and pairings as genome_clustering, keeping in memory only the similarities of two blocks of
+ *neighborhoods at a time: the neighborhoods are split into blocks so two of them fit in options.memory_budget and
+ *every pair of blocks (I, J), I <= J, is compared on a ProteinCollection with only their proteins. The pairs of
+ *blocks are taken row by row, going back and forth along the rows, so one of the two blocks is always resident
+ *already. The results of each pair of blocks are written together, in the order of its rows.
+ *Overlapping windows are not compared together (the scores are the same).
+ *With options.first_reference, the pairs of blocks without the pairs of a query and a reference are skipped.
+ *The memory of each pair of blocks and the bytes read from the graph for it are printed to stderr.
+ */
+void genome_clustering_blocked(NeighborhoodStore &neighborhoods, const CompiledGraph &graph, bool normalize,
+                               const std::string &method, double prot_stringency, double neigh_stringency,
+                               const std::string &genome_sim_filename, const std::string &pairings_filename,
+                               const clustering_options_t &options) {
+
+    std::vector<method_output_t> outputs = open_method_outputs(method, genome_sim_filename, pairings_filename);
+    bool has_porthodom;
+    int min_proteins = min_method_proteins(outputs, has_porthodom);
+
+    if (options.seed_window >= 0)
+        neighborhoods.set_seed_window(options.seed_window);
+
+    //Identical neighborhoods are found by the graph ids of their proteins, shared by all the blocks
+    std::vector<unsigned int> blocks = split_blocks(neighborhoods, graph, options.memory_budget);
+    result_cache_t cache;
+    fill_result_cache(cache, neighborhoods, options.seed_anchor, options.first_reference);
+    std::cerr << "Neighborhoods split into " << blocks.size() - 1 << " blocks\n";
+
+    //A rectangular run only compares the pairs of blocks with queries and references
+    unsigned int rows_end = options.first_reference > 0 ? options.first_reference : neighborhoods.size();
+
+    row_queue_t queue;
+    queue.neighborhoods = &neighborhoods;
+    queue.outputs = &outputs;
+    queue.pairings_filename = pairings_filename;
+    queue.min_proteins = min_proteins;
+    queue.group_of.assign(neighborhoods.size(), -1);
+    queue.row_buffers.resize(neighborhoods.size());
+    queue.pairs_begin = 0;
+    queue.pairs_end = ~0ULL;
+    queue.rows_end = rows_end;
+    queue.checkpoint = NULL;
+
+    std::vector<pair_comparer_t> comparers(std::max(options.threads, 1));
+    init_comparers(comparers, outputs, NULL, prot_stringency, neigh_stringency, options, has_porthodom, cache);
+
+    std::map<unsigned int, graph_block_t> resident;
+    for (unsigned int I = 0; I + 1 < blocks.size(); I++) {
+        for (unsigned int step = I; step + 1 < blocks.size(); step++) {
+            unsigned int J = I % 2 == 0 ? step : blocks.size() - 2 - (step - I);
+            if (blocks[I] >= rows_end || blocks[J + 1] <= options.first_reference) continue;
+
+            //Only blocks I and J stay resident
+            for (std::map<unsigned int, graph_block_t>::iterator it = resident.begin(); it != resident.end(); )
+                it = it->first != I && it->first != J ? resident.erase(it) : ++it;
+            size_t bytes_read = 0;
+            unsigned int needed[2] = {I, J};
+            for (unsigned int b = 0; b < 2; b++)
+                if (!resident.count(needed[b]))
+                    bytes_read += load_block(neighborhoods, graph, blocks[needed[b]], blocks[needed[b] + 1],
+                                             resident[needed[b]]);
+            graph_block_t &block1 = resident[I], &block2 = resident[J];
+
+            ProteinCollection clusters = block_pair_collection(graph, block1, block2, normalize);
+            neighborhoods.resolve(clusters, block1.first, block1.last);
+            neighborhoods.resolve(clusters, block2.first, block2.last);
+            for (unsigned int t = 0; t < comparers.size(); t++)
+                comparers[t].clusters = &clusters;
+
+            queue.rows.clear();
+            for (unsigned int m = block1.first; m < std::min(block1.last, rows_end); m++)
+                if (neighborhoods.protein_count(m) >= min_proteins)
+                    queue.rows.push_back(m);
+            queue.columns_begin = std::max(block2.first, options.first_reference);
+            queue.columns_end = block2.last;
+            compare_queue(comparers, queue);
+
+            //Results kept for identical neighborhoods are dropped with the blocks, so they don't pile up
+            cache.results.clear();
+
+            std::cerr << "Block pair " << I << " x " << J << " (neighborhoods " << block1.first << "-" << block1.last - 1
+                      << " x " << block2.first << "-" << block2.last - 1 << "): " << clusters.size() << " proteins, "
+                      << bytes_read << " bytes read, peak memory " << peak_memory_mb() << " MB\n";
+        }
+    }
+    print_comparer_stats(comparers);
+}
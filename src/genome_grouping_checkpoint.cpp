@@ -0,0 +1,141 @@
+#include "genome_grouping_common.h"
+#include <fcntl.h>
+
+/**
+ *Adds data to a 64-bit FNV-1a hash
+ */
+static void hash_bytes(unsigned long long &hash, const void *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= ((const unsigned char *)data)[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+/**
+ *Receives the inputs of a genome_clustering run and the settings that change its output.
+ *Returns their fingerprint: a hash of the neighborhoods, of the similarities between the proteins and of the settings
+ */
+std::string run_fingerprint(NeighborhoodStore &neighborhoods, ProteinCollection &clusters,
+                            const std::string &settings) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned int n = 0; n < neighborhoods.size(); n++) {
+        const std::string &accession = neighborhoods.get_accession(n);
+        hash_bytes(hash, accession.data(), accession.size() + 1);
+        int last_cds = neighborhoods.get_last_cds(n);
+        hash_bytes(hash, &last_cds, sizeof(last_cds));
+    }
+    for (unsigned int p = 0; p < neighborhoods.total_proteins(); p++) {
+        unsigned long long key = neighborhoods.pid_key(p);
+        int cds = neighborhoods.cds_begin(p);
+        hash_bytes(hash, &key, sizeof(key));
+        hash_bytes(hash, &cds, sizeof(cds));
+    }
+
+    //The similarities are added up in any order, as they are kept in hash tables
+    unsigned long long similarities = 0;
+    for (size_t i = 0; i < clusters.size(); i++) {
+        const std::unordered_map<int, double> &neighbors = clusters.lower_neighbors(i);
+        for (std::unordered_map<int, double>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
+            unsigned long long similarity = 14695981039346656037ULL;
+            hash_bytes(similarity, &i, sizeof(i));
+            hash_bytes(similarity, &it->first, sizeof(it->first));
+            hash_bytes(similarity, &it->second, sizeof(it->second));
+            similarities += similarity;
+        }
+    }
+    hash_bytes(hash, &similarities, sizeof(similarities));
+    hash_bytes(hash, settings.data(), settings.size());
+
+    std::ostringstream fingerprint;
+    fingerprint << std::hex << hash;
+    return fingerprint.str();
+}
+
+/**
+ *Writes the data of a file to disk
+ */
+static void sync_file(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/**
+ *Receives a row queue with a checkpoint.
+ *Flushes the outputs and saves the point they are at: the next row to compare and the size of each output. The
+ *checkpoint is written to a temporary file and renamed over the previous one, so there always is a whole one.
+ */
+void write_checkpoint(row_queue_t &queue) {
+    std::vector<method_output_t> &outputs = *queue.outputs;
+    checkpoint_t &checkpoint = *queue.checkpoint;
+    unsigned int next_row = queue.written < queue.rows.size() ? queue.rows[queue.written] : queue.neighborhoods->size();
+
+    std::string temporary = checkpoint.filename + ".tmp";
+    std::ofstream file(temporary.c_str());
+    file << "fingerprint " << checkpoint.fingerprint << "\n"
+         << "next_row " << next_row << "\n";
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        outputs[k].output_file.flush();
+        outputs[k].pairings_file.flush();
+        file << outputs[k].method << " " << (long long)outputs[k].output_file.tellp() << " "
+             << (checkpoint.files[2*k + 1].empty() ? 0 : (long long)outputs[k].pairings_file.tellp()) << "\n";
+    }
+    file.close();
+    if (file.fail()) {
+        std::cerr << "ERROR: trouble writing the checkpoint file\n";
+        exit(1);
+    }
+
+    for (unsigned int f = 0; f < checkpoint.files.size(); f++)
+        if (!checkpoint.files[f].empty())
+            sync_file(checkpoint.files[f]);
+    sync_file(temporary);
+    if (rename(temporary.c_str(), checkpoint.filename.c_str()) != 0) {
+        std::cerr << "ERROR: trouble writing the checkpoint file\n";
+        exit(1);
+    }
+    checkpoint.last = std::chrono::steady_clock::now();
+}
+
+/**
+ *Receives a checkpoint (its filename, fingerprint and files).
+ *Returns the next row to compare saved in its file, after truncating the outputs to their sizes at that point, or 0
+ *if there is no checkpoint file.
+ */
+unsigned int read_checkpoint(checkpoint_t &checkpoint, std::vector<method_output_t> &methods) {
+    std::ifstream file(checkpoint.filename.c_str());
+    if (file.fail()) {
+        std::cerr << "No checkpoint found at " << checkpoint.filename << ", starting from the beginning\n";
+        return 0;
+    }
+
+    std::string field, fingerprint;
+    unsigned int next_row;
+    file >> field >> fingerprint >> field >> next_row;
+    if (file.fail() || fingerprint != checkpoint.fingerprint) {
+        std::cerr << "ERROR: the checkpoint " << checkpoint.filename << " is from a different comparison\n";
+        exit(1);
+    }
+    for (unsigned int k = 0; k < methods.size(); k++) {
+        std::string method;
+        long long sizes[2];
+        file >> method >> sizes[0] >> sizes[1];
+        if (file.fail() || method != methods[k].method) {
+            std::cerr << "ERROR: the checkpoint " << checkpoint.filename << " is from a different comparison\n";
+            exit(1);
+        }
+        for (unsigned int f = 2*k; f < 2*k + 2; f++) {
+            struct stat info;
+            if (checkpoint.files[f].empty()) continue;
+            if (stat(checkpoint.files[f].c_str(), &info) != 0 || info.st_size < sizes[f - 2*k] ||
+                truncate(checkpoint.files[f].c_str(), sizes[f - 2*k]) != 0) {
+                std::cerr << "ERROR: " << checkpoint.files[f] << " is shorter than its checkpoint\n";
+                exit(1);
+            }
+        }
+    }
+    std::cerr << "Resuming from " << checkpoint.filename << " at neighborhood " << next_row << "\n";
+    return next_row;
+}
@@ -0,0 +1,222 @@
+#ifndef __GENOME_GROUPING_COMMON_H__
+#define __GENOME_GROUPING_COMMON_H__
+
+/*
+ *Declarations shared by the modules of the execution modes of genome_grouping.h (genome_grouping_*.cpp), not
+ *used outside of them
+ */
+
+#include "genome_grouping.h"
+
+/**
+ *Output files of one of the neighborhood comparing methods requested in a run
+ */
+typedef struct {
+    std::string method;
+    int order;        //length of the runs of proteins compared by the porthodom Ok methods, 0 for the others
+    int min_proteins; //neighborhoods with less proteins are ignored by the method
+    std::ofstream output_file;
+    std::ofstream pairings_file;
+} method_output_t;
+
+/**
+ *Result of one of the methods for a pair of neighborhoods
+ */
+typedef struct {
+    bool found;   //false if the score is below the neighborhood stringency (nothing is written)
+    double score;
+    assignments_t assignments;
+} method_result_t;
+
+/**
+ *Overlapping windows of the same accession (e.g. around seeds close to each other): the proteins of each window are
+ *a run of consecutive proteins of their region
+ */
+typedef struct {
+    std::vector<unsigned int> members; //indexes of the windows, in the order of the region
+    std::vector<int> offsets;          //position of the first protein of each window in the region
+    std::vector<unsigned int> region;  //proteins of the region (their positions in the NeighborhoodStore)
+    std::vector<long> region_indexes;  //and their indexes in the ProteinCollection
+} window_group_t;
+
+/**
+ *Results of pairs of classes of identical neighborhoods, kept while a later pair can reuse them (at most
+ *RESULT_CACHE_MAX_PAIRS of them, the others are compared again). Shared by the threads
+ */
+typedef struct {
+    std::vector<int> classes;
+    std::vector<unsigned int> last_member; //last neighborhood of each class
+    std::vector<unsigned int> next_member; //next neighborhood of the class of each one, itself for the last one
+    std::map<std::pair<int, int>, std::vector<method_result_t> > results;
+    std::mutex lock;
+} result_cache_t;
+
+/**
+ *Compares pairs of neighborhoods with every requested method, holding what is shared by all pairs and what is
+ *reused from one pair to the next. Each thread has its own
+ */
+typedef struct {
+    Arena arena; //memory of the pair being compared, reset after each one
+    std::vector<method_output_t> *outputs;
+    ProteinCollection *clusters;
+    double prot_stringency;
+    double neigh_stringency;
+    clustering_options_t options;
+    bool has_porthodom;
+    result_cache_t *cache;
+
+    SimilarityBlock block;
+    std::vector<method_result_t> results;
+    assignments_t assignments;
+    std::vector<int> cold_start; //potentials of solvers not warm started
+    clustering_stats_t stats;
+} pair_comparer_t;
+
+/**
+ *Checkpoints of a genome_clustering run: the last consistent point of its outputs, kept in a file next to them
+ */
+typedef struct {
+    std::string filename;
+    std::string fingerprint;            //of the inputs of the run (see run_fingerprint)
+    std::vector<std::string> files;     //output and pairings files of each method ("" if not written)
+    int interval;                       //seconds between checkpoints
+    std::chrono::steady_clock::time_point last; //time of the last one
+} checkpoint_t;
+
+/**
+ *Rows of the comparison (the pairs of a neighborhood with the ones after it), taken in order by the threads. Each
+ *thread compares a row into its own buffers and writes them once every previous row has been written
+ */
+typedef struct {
+    NeighborhoodStore *neighborhoods;
+    std::vector<method_output_t> *outputs;
+    std::string pairings_filename;
+    int min_proteins;
+
+    //Overlapping windows of the same accession are compared together, at the turn of the first of them
+    std::vector<window_group_t> groups;
+    std::vector<int> group_of;
+    std::vector<std::vector<std::string> > row_buffers; //results of windows compared before their turn
+
+    std::vector<unsigned int> rows;  //neighborhoods with enough proteins for some method
+    unsigned int rows_end;           //rows after it are not compared (the references of a rectangular run)
+    unsigned int columns_begin;      //neighborhoods compared with the rows (the ones after each row among them)
+    unsigned int columns_end;
+    unsigned long long pairs_begin;  //triangle indexes of the pairs compared (see triangle_index)
+    unsigned long long pairs_end;
+    std::atomic<unsigned int> next;  //next row to be taken
+    unsigned int written;            //rows already written
+    checkpoint_t *checkpoint;        //saved after the rows are written, NULL for none
+    std::mutex lock;
+    std::condition_variable turn;
+} row_queue_t;
+
+/**
+ *A block of consecutive neighborhoods for genome_clustering_blocked: the graph ids of their proteins and the
+ *similarities of each of them to the proteins of smaller or equal id, copied from the compiled graph while the block
+ *is resident
+ */
+typedef struct {
+    unsigned int first;                      //neighborhoods first to last - 1
+    unsigned int last;
+    std::vector<long> ids;                   //graph ids of the proteins, sorted
+    std::vector<unsigned long long> offsets; //start of the similarities of each id, followed by the end of the last one
+    std::vector<unsigned int> neighbors;
+    std::vector<double> weights;
+} graph_block_t;
+
+/**
+ *Index of the neighborhoods with each protein, to find the ones with a protein similar to one of another neighborhood
+ *(the only ones it can score above 0 with)
+ */
+typedef struct {
+    std::vector<unsigned long long> similar_offsets; //proteins similar to each protein of the ProteinCollection...
+    std::vector<int> similar;                        //...from similar_offsets[i] to similar_offsets[i + 1] - 1
+    std::vector<std::vector<unsigned int> > neighborhoods_of; //indexed neighborhoods with each protein
+} neighborhood_index_t;
+
+//genome_grouping.cpp: outputs of the methods and comparison of the pairs, shared by the execution modes
+
+std::vector<std::string> split(const std::string& in, const std::string& delim);
+
+void append_neighborhood(std::string &buffer, const GenomicNeighborhood &g);
+
+void output_score(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, double score, std::string &output_file);
+
+std::vector<method_output_t> method_outputs(const std::string &method);
+
+std::vector<method_output_t> open_method_outputs(const std::string &method, const std::string &genome_sim_filename,
+                                                 const std::string &pairings_filename, bool append = false);
+
+void compare_pair(pair_comparer_t &comparer, const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                  const SimilarityBlock *region_block, std::vector<std::vector<int> > *potentials);
+
+void output_pair(pair_comparer_t &comparer, NeighborhoodStore &neighborhoods, unsigned int m,
+                 unsigned int n, const SimilarityBlock *region_block, std::vector<std::vector<int> > *potentials,
+                 const std::string &pairings_filename, std::vector<std::string> &buffers);
+
+unsigned long long triangle_index(unsigned long long m, unsigned long long n, unsigned long long count);
+
+void row_columns(row_queue_t &queue, unsigned int m, unsigned int &begin, unsigned int &end);
+
+extern std::atomic<bool> termination_requested;
+
+void request_termination(int);
+
+void print_stats(clustering_stats_t &stats);
+
+void add_stats(clustering_stats_t &total, const clustering_stats_t &stats);
+
+int min_method_proteins(std::vector<method_output_t> &outputs, bool &has_porthodom);
+
+void fill_result_cache(result_cache_t &cache, NeighborhoodStore &neighborhoods, bool with_seeds,
+                       unsigned int first_reference);
+
+void init_comparers(std::vector<pair_comparer_t> &comparers, std::vector<method_output_t> &outputs,
+                    ProteinCollection *clusters, double prot_stringency, double neigh_stringency,
+                    const clustering_options_t &options, bool has_porthodom, result_cache_t &cache);
+
+void compare_queue(std::vector<pair_comparer_t> &comparers, row_queue_t &queue);
+
+void print_comparer_stats(std::vector<pair_comparer_t> &comparers);
+
+void compare_pairs(std::vector<pair_comparer_t> &comparers, NeighborhoodStore &neighborhoods,
+                   const std::pair<unsigned int, unsigned int> *batch, size_t size,
+                   const std::string &pairings_filename, std::vector<std::vector<std::string> > &results);
+
+std::vector<unsigned long long> split_pairs(NeighborhoodStore &neighborhoods, int min_proteins,
+                                            unsigned int first_column, unsigned int rows_end, int parts);
+
+//genome_grouping_checkpoint.cpp
+
+std::string run_fingerprint(NeighborhoodStore &neighborhoods, ProteinCollection &clusters, const std::string &settings);
+
+void write_checkpoint(row_queue_t &queue);
+
+unsigned int read_checkpoint(checkpoint_t &checkpoint, std::vector<method_output_t> &methods);
+
+//genome_grouping_blocked.cpp
+
+size_t load_block_ids(const CompiledGraph &graph, graph_block_t &block);
+
+ProteinCollection block_pair_collection(const CompiledGraph &graph, graph_block_t &block1, graph_block_t &block2,
+                                        bool normalize);
+
+//genome_grouping_stream.cpp
+
+void similar_proteins(ProteinCollection &clusters, std::vector<unsigned long long> &offsets, std::vector<int> &similar);
+
+void index_neighborhood(neighborhood_index_t &index, NeighborhoodStore &neighborhoods, unsigned int n);
+
+void candidate_neighborhoods(const neighborhood_index_t &index, const long *indexes, int count,
+                             std::vector<unsigned int> &stamps, unsigned int stamp,
+                             std::vector<unsigned int> &candidates);
+
+//genome_grouping_serve.cpp
+
+double serve_pair(pair_comparer_t &comparer, const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                  std::string &response);
+
+void append_ranked(std::vector<std::pair<double, std::string> > &partners, int k, std::string &response);
+
+#endif
@@ -0,0 +1,118 @@
+#include "genome_grouping_common.h"
+
+/**
+ *Receives a compiled graph, the graph ids of the proteins of a query neighborhood and of its partners (sorted, without
+ *repetitions), and whether the similarities are normalized.
+ *Returns the ProteinCollection with those proteins (by their position in ids) and the similarities of the proteins of
+ *the query, the only ones its comparisons read.
+ */
+static ProteinCollection query_collection(const CompiledGraph &graph, const std::vector<long> &query_ids,
+                                          const std::vector<long> &ids, bool normalize) {
+    ProteinCollection clusters(ids.size());
+    for (unsigned int k = 0; k < ids.size(); k++)
+        clusters.add_protein(graph.name(ids[k]));
+
+    for (unsigned int q = 0; q < query_ids.size(); q++) {
+        long id = query_ids[q];
+        long index = std::lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+        const unsigned int *neighbors = graph.neighbors_of(id);
+        const double *weights = graph.weights_of(id);
+        for (long k = 0; k < graph.degree(id); k++) {
+            //Similarities between two proteins of the query are connected once
+            if (neighbors[k] > id && std::binary_search(query_ids.begin(), query_ids.end(), (long)neighbors[k])) continue;
+            std::vector<long>::const_iterator found = std::lower_bound(ids.begin(), ids.end(), (long)neighbors[k]);
+            if (found != ids.end() && *found == neighbors[k])
+                clusters.connect_proteins(index, found - ids.begin(), weights[k]);
+        }
+    }
+    if (normalize)
+        clusters.normalize(graph.max_similarity());
+    return clusters;
+}
+
+/**
+ *Each query neighborhood is compared with the neighborhoods of the index with a protein similar to one of it (found
+ *with the postings of the similar proteins), taken from the index with their proteins into a small store, as if the
+ *query were after them.
+ */
+void genome_clustering_query(NeighborhoodStore &queries, const NeighborhoodIndex &index, const CompiledGraph &graph,
+                             bool normalize, const std::string &method, double prot_stringency, double neigh_stringency,
+                             int top, const std::string &genome_sim_filename, const clustering_options_t &options) {
+    std::vector<method_output_t> outputs = method_outputs(method);
+    bool has_porthodom;
+    int min_proteins = min_method_proteins(outputs, has_porthodom);
+    std::ofstream output_file;
+    if (genome_sim_filename == "-")
+        output_file.basic_ios<char>::rdbuf(std::cout.rdbuf());
+    else
+        output_file.open(genome_sim_filename.c_str());
+
+    result_cache_t cache;
+    std::vector<pair_comparer_t> comparers(1);
+    init_comparers(comparers, outputs, NULL, prot_stringency, neigh_stringency, options, has_porthodom, cache);
+    pair_comparer_t &comparer = comparers[0];
+    Arena::Scope scope(&comparer.arena);
+
+    if (options.seed_window >= 0)
+        queries.set_seed_window(options.seed_window);
+    std::vector<unsigned int> stamps(index.size(), 0);
+    unsigned long long candidate_count = 0;
+    for (unsigned int q = 0; q < queries.size(); q++) {
+        queries.resolve(graph, q, q + 1);
+        if (queries.protein_count(q) < min_proteins) continue;
+        std::vector<long> query_ids;
+        for (int i = 0; i < queries.protein_count(q); i++)
+            if (queries.protein_indexes(q)[i] >= 0)
+                query_ids.push_back(queries.protein_indexes(q)[i]);
+        std::sort(query_ids.begin(), query_ids.end());
+        query_ids.erase(std::unique(query_ids.begin(), query_ids.end()), query_ids.end());
+
+        std::vector<unsigned int> candidates;
+        for (unsigned int i = 0; i < query_ids.size(); i++) {
+            const unsigned int *neighbors = graph.neighbors_of(query_ids[i]);
+            for (long k = 0; k < graph.degree(query_ids[i]); k++)
+                for (unsigned long long p = 0; p < index.posting_count(neighbors[k]); p++) {
+                    unsigned int n = index.postings(neighbors[k])[p];
+                    if (stamps[n] == q + 1) continue;
+                    stamps[n] = q + 1;
+                    candidates.push_back(n);
+                }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidate_count += candidates.size();
+
+        NeighborhoodStore partners;
+        for (unsigned int c = 0; c < candidates.size(); c++)
+            index.add_to(partners, candidates[c], graph);
+        if (options.seed_window >= 0)
+            partners.set_seed_window(options.seed_window);
+
+        partners.resolve(graph, 0, partners.size());
+        std::vector<long> ids(query_ids);
+        for (unsigned int n = 0; n < partners.size(); n++)
+            for (int i = 0; i < partners.protein_count(n); i++)
+                if (partners.protein_indexes(n)[i] >= 0)
+                    ids.push_back(partners.protein_indexes(n)[i]);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        ProteinCollection clusters = query_collection(graph, query_ids, ids, normalize);
+        comparer.clusters = &clusters;
+        partners.resolve(clusters);
+        queries.resolve(clusters, q, q + 1);
+
+        std::vector<std::pair<double, std::string> > ranked;
+        for (unsigned int n = 0; n < partners.size(); n++) {
+            if (partners.protein_count(n) < min_proteins) continue;
+            std::string results;
+            double score = serve_pair(comparer, GenomicNeighborhood(partners, n), GenomicNeighborhood(queries, q), results);
+            if (!results.empty())
+                ranked.push_back(std::make_pair(score, results));
+        }
+        std::string response;
+        append_ranked(ranked, top > 0 ? top : ranked.size(), response);
+        output_file << response;
+    }
+    std::cerr << "Neighborhoods of the index compared with the queries: " << candidate_count << "\n";
+    print_comparer_stats(comparers);
+}
@@ -0,0 +1,347 @@
+#include "genome_grouping_common.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ *Neighborhoods and similarities a server answers from (see genome_clustering_serve)
+ */
+typedef struct {
+    ProteinCollection clusters;
+    NeighborhoodStore neighborhoods;  //of the server, resolved in clusters
+    neighborhood_index_t index;       //of the neighborhoods compared by some method
+} server_state_t;
+
+/**
+ *Shared by the threads of genome_clustering_serve
+ */
+typedef struct {
+    std::string prot_sim_filename;
+    bool normalize;
+    int min_proteins;
+    NeighborhoodStore *neighborhoods;   //as read, copied into each state
+    std::unordered_map<std::string, unsigned int> keys; //first neighborhood of each accession and first coordinate
+    std::shared_ptr<server_state_t> state; //replaced as a whole when the similarities change (std::atomic_store), so
+                                           //the requests being answered keep the one they started with
+    std::deque<int> connections;        //accepted, waiting for a thread
+    std::mutex lock;
+    std::condition_variable ready;
+} server_t;
+
+/**
+ *Returns the key of a neighborhood in server_t::keys
+ */
+static std::string neighborhood_key(const std::string &accession, const std::string &first_cds) {
+    return accession + '\t' + first_cds;
+}
+
+/**
+ *Reads the similarities of a server into a new state
+ */
+static std::shared_ptr<server_state_t> load_server_state(server_t &server) {
+    std::shared_ptr<server_state_t> state = std::make_shared<server_state_t>();
+    state->clusters = protein_clustering(server.prot_sim_filename, 0);
+    if (server.normalize)
+        state->clusters.normalize();
+
+    state->neighborhoods = *server.neighborhoods;
+    state->neighborhoods.resolve(state->clusters);
+    similar_proteins(state->clusters, state->index.similar_offsets, state->index.similar);
+    state->index.neighborhoods_of.resize(state->clusters.size());
+    for (unsigned int n = 0; n < state->neighborhoods.size(); n++)
+        if (state->neighborhoods.protein_count(n) >= server.min_proteins)
+            index_neighborhood(state->index, state->neighborhoods, n);
+    return state;
+}
+
+/**
+ *Receives a file and, if it exists, sets its modification time and size.
+ *Returns false if it doesn't exist
+ */
+static bool file_version(const std::string &filename, std::pair<long long, long long> &modified, long long &size) {
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) return false;
+    modified = std::make_pair((long long)info.st_mtim.tv_sec, (long long)info.st_mtim.tv_nsec);
+    size = info.st_size;
+    return true;
+}
+
+/**
+ *Reads the similarities again when their file changes, once it has been left unchanged for SERVE_POLL_MS (so a file
+ *being written is not read half done)
+ */
+static void watch_similarities(server_t &server) {
+    std::pair<long long, long long> loaded_modified, seen_modified;
+    long long loaded_size = -1, seen_size = -1;
+    file_version(server.prot_sim_filename, loaded_modified, loaded_size);
+
+    while (!termination_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SERVE_POLL_MS));
+        std::pair<long long, long long> modified;
+        long long size;
+        if (!file_version(server.prot_sim_filename, modified, size) ||
+            (modified == loaded_modified && size == loaded_size)) continue;
+
+        if (modified == seen_modified && size == seen_size) {
+            std::atomic_store(&server.state, load_server_state(server));
+            loaded_modified = modified;
+            loaded_size = size;
+            std::cerr << "Reloaded the protein similarities of " << server.prot_sim_filename << "\n";
+        }
+        seen_modified = modified;
+        seen_size = size;
+    }
+}
+
+/**
+ *Compares neighborhoods g1 and g2 and appends the scores found by the methods to the response, as in their output
+ *files (preceded by the name of the method if there are more than one).
+ *Returns the score of the first method, -1 if it found none
+ */
+double serve_pair(pair_comparer_t &comparer, const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                  std::string &response) {
+    std::vector<method_output_t> &outputs = *comparer.outputs;
+    compare_pair(comparer, g1, g2, NULL, NULL);
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        if (!comparer.results[k].found) continue;
+        if (outputs.size() > 1) {
+            response += outputs[k].method;
+            response += '\t';
+        }
+        output_score(g1, g2, comparer.results[k].score, response);
+    }
+    double score = comparer.results[0].found ? comparer.results[0].score : -1;
+
+    for (unsigned int k = 0; k < comparer.results.size(); k++)
+        comparer.results[k].assignments.clear();
+    comparer.assignments.clear();
+    comparer.arena.reset();
+    return score;
+}
+
+/**
+ *Receives the results of the partners of a neighborhood and the score of each one by the first method.
+ *Appends the results of the k best ones to the response, best first (in their order if tied)
+ */
+void append_ranked(std::vector<std::pair<double, std::string> > &partners, int k, std::string &response) {
+    std::stable_sort(partners.begin(), partners.end(), [](const std::pair<double, std::string> &a,
+                                                          const std::pair<double, std::string> &b) {
+        return a.first > b.first;
+    });
+    for (int i = 0; i < k && i < (int)partners.size(); i++)
+        response += partners[i].second;
+}
+
+/**
+ *Compares neighborhood g, the n-th of a state (or after all of them if n is ~0U), with the other neighborhoods of the
+ *state with a protein similar to one of it (the others score 0), each pair in the order of the neighborhoods, and
+ *appends the results of the k best ones by the first method to the response, best first
+ */
+static void serve_partners(pair_comparer_t &comparer, server_state_t &state, const GenomicNeighborhood &g,
+                           unsigned int n, int k, int min_proteins, std::vector<unsigned int> &stamps,
+                           unsigned int stamp, std::string &response) {
+    std::vector<unsigned int> candidates;
+    candidate_neighborhoods(state.index, g.indexes(), g.protein_count(), stamps, stamp, candidates);
+
+    std::vector<std::pair<double, std::string> > partners; //score of the first method and results
+    for (unsigned int c = 0; c < candidates.size(); c++) {
+        if (candidates[c] == n || state.neighborhoods.protein_count(candidates[c]) < min_proteins) continue;
+        std::string results;
+        GenomicNeighborhood partner(state.neighborhoods, candidates[c]);
+        double score = candidates[c] < n ? serve_pair(comparer, partner, g, results) : serve_pair(comparer, g, partner, results);
+        if (!results.empty())
+            partners.push_back(std::make_pair(score, results));
+    }
+    append_ranked(partners, k, response);
+}
+
+/**
+ *Receives the accession and first coordinate of a neighborhood of a server and sets its index.
+ *Returns false if there is no such neighborhood
+ */
+static bool find_neighborhood(server_t &server, const std::string &accession, const std::string &first_cds,
+                              unsigned int &n) {
+    std::unordered_map<std::string, unsigned int>::const_iterator key = server.keys.find(neighborhood_key(accession, first_cds));
+    if (key == server.keys.end()) return false;
+    n = key->second;
+    return true;
+}
+
+/**
+ *Receives a request line (see genome_clustering_serve).
+ *Returns its response, ended by an empty line
+ */
+static std::string answer_request(server_t &server, pair_comparer_t &comparer, const std::string &request,
+                                  std::vector<unsigned int> &stamps, unsigned int &stamp) {
+    std::vector<std::string> fields = split(request, " \t\r");
+    std::shared_ptr<server_state_t> state = std::atomic_load(&server.state);
+    NeighborhoodStore &neighborhoods = state->neighborhoods;
+    comparer.clusters = &state->clusters;
+    stamps.resize(neighborhoods.size(), 0);
+
+    std::string response;
+    unsigned int m, n;
+    if (fields.size() == 5 && fields[0] == "score") {
+        if (!find_neighborhood(server, fields[1], fields[2], m) || !find_neighborhood(server, fields[3], fields[4], n))
+            return "ERROR: unknown neighborhood\n\n";
+        if (neighborhoods.protein_count(m) >= server.min_proteins && neighborhoods.protein_count(n) >= server.min_proteins)
+            serve_pair(comparer, GenomicNeighborhood(neighborhoods, std::min(m, n)), GenomicNeighborhood(neighborhoods, std::max(m, n)),
+                       response);
+    }
+    else if (fields.size() == 4 && fields[0] == "top") {
+        if (!find_neighborhood(server, fields[2], fields[3], n))
+            return "ERROR: unknown neighborhood\n\n";
+        if (neighborhoods.protein_count(n) >= server.min_proteins)
+            serve_partners(comparer, *state, GenomicNeighborhood(neighborhoods, n), n, std::atoi(fields[1].c_str()),
+                           server.min_proteins, stamps, ++stamp, response);
+    }
+    else if (fields.size() >= 3 && fields[0] == "genes") {
+        NeighborhoodStore query;
+        query.add_neighborhood("query");
+        for (unsigned int i = 2; i < fields.size(); i++)
+            query.add_protein(fields[i], "0..0");
+        query.resolve(state->clusters);
+        if (query.protein_count(0) >= server.min_proteins)
+            serve_partners(comparer, *state, GenomicNeighborhood(query, 0), ~0U, std::atoi(fields[1].c_str()),
+                           server.min_proteins, stamps, ++stamp, response);
+    }
+    else
+        return "ERROR: unknown request\n\n";
+    return response + '\n';
+}
+
+/**
+ *Receives a connection and the text read from it and not used yet.
+ *Reads the next line of the connection. Returns false at its end or at termination
+ */
+static bool read_request(int connection, std::string &buffer, std::string &line) {
+    char chunk[4096];
+    for (size_t end = buffer.find('\n'); end == std::string::npos; end = buffer.find('\n')) {
+        if (termination_requested) return false;
+        struct pollfd ready = {connection, POLLIN, 0};
+        if (poll(&ready, 1, SERVE_POLL_MS) <= 0) continue;
+        ssize_t bytes = read(connection, chunk, sizeof(chunk));
+        if (bytes <= 0) {
+            if (buffer.empty()) return false;
+            buffer += '\n'; //last line, without a line break
+        }
+        else
+            buffer.append(chunk, bytes);
+    }
+    size_t end = buffer.find('\n');
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+/**
+ *Answers the requests of the connections accepted by a server, one connection at a time, until termination
+ */
+static void serve_connections(server_t &server, pair_comparer_t &comparer) {
+    Arena::Scope scope(&comparer.arena);
+    std::vector<unsigned int> stamps;
+    unsigned int stamp = 0;
+
+    while (true) {
+        int connection;
+        {
+            std::unique_lock<std::mutex> guard(server.lock);
+            while (server.connections.empty() && !termination_requested)
+                server.ready.wait_for(guard, std::chrono::milliseconds(SERVE_POLL_MS));
+            if (server.connections.empty()) return;
+            connection = server.connections.front();
+            server.connections.pop_front();
+        }
+
+        std::string buffer, request;
+        while (read_request(connection, buffer, request)) {
+            std::string response = answer_request(server, comparer, request, stamps, stamp);
+            size_t sent = 0;
+            while (sent < response.size()) {
+                ssize_t bytes = send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (bytes <= 0) break;
+                sent += bytes;
+            }
+            if (sent < response.size()) break;
+        }
+        close(connection);
+    }
+}
+
+/**
+ *Each request is a line, answered by lines ended by an empty line (or by a line starting with "ERROR:" and an empty
+ *line). Neighborhoods are named by their accession and first coordinate, as in the output files:
+ *  score <accession1> <first_cds1> <accession2> <first_cds2>   the scores of the pair
+ *  top <k> <accession> <first_cds>     the k best partners of the neighborhood by the first method, best first
+ *  genes <k> <pid1> <pid2> ...         the same for a neighborhood with these proteins, named query (coordinates 0)
+ *                                      and compared as if it were after the others
+ *The results are the lines of the output files, each pair in the order of the neighborhoods, so only scores from
+ *neigh_stringency on are written. The partners are found among the neighborhoods with a protein similar to one of the
+ *neighborhood, with an index of the neighborhoods of each protein.
+ */
+void genome_clustering_serve(NeighborhoodStore &neighborhoods, const std::string &prot_sim_filename, bool normalize,
+                             const std::string &method, double prot_stringency, double neigh_stringency,
+                             const std::string &socket_filename, const clustering_options_t &options) {
+    std::vector<method_output_t> outputs = method_outputs(method);
+    bool has_porthodom;
+    if (options.seed_window >= 0)
+        neighborhoods.set_seed_window(options.seed_window);
+
+    server_t server;
+    server.prot_sim_filename = prot_sim_filename;
+    server.normalize = normalize;
+    server.min_proteins = min_method_proteins(outputs, has_porthodom);
+    server.neighborhoods = &neighborhoods;
+    for (unsigned int n = 0; n < neighborhoods.size(); n++) {
+        char first_cds[16];
+        snprintf(first_cds, sizeof(first_cds), "%d", neighborhoods.get_first_cds(n));
+        server.keys.insert(std::make_pair(neighborhood_key(neighborhoods.get_accession(n), first_cds), n));
+    }
+    server.state = load_server_state(server);
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_filename.size() >= sizeof(address.sun_path)) {
+        std::cerr << "ERROR: the socket filename is too long\n";
+        exit(1);
+    }
+    strcpy(address.sun_path, socket_filename.c_str());
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_filename.c_str());
+    if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "ERROR: trouble listening on " << socket_filename << "\n";
+        exit(1);
+    }
+    std::signal(SIGTERM, request_termination);
+    std::signal(SIGINT, request_termination);
+
+    result_cache_t cache;
+    std::vector<pair_comparer_t> comparers(std::max(options.threads, 1));
+    init_comparers(comparers, outputs, &server.state->clusters, prot_stringency, neigh_stringency, options,
+                   has_porthodom, cache);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < comparers.size(); t++)
+        workers.push_back(std::thread(serve_connections, std::ref(server), std::ref(comparers[t])));
+    workers.push_back(std::thread(watch_similarities, std::ref(server)));
+    std::cout << "Listening on " << socket_filename << std::endl;
+
+    while (!termination_requested) {
+        struct pollfd ready = {listener, POLLIN, 0};
+        if (poll(&ready, 1, SERVE_POLL_MS) <= 0) continue;
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) continue;
+        std::lock_guard<std::mutex> guard(server.lock);
+        server.connections.push_back(connection);
+        server.ready.notify_one();
+    }
+
+    server.ready.notify_all();
+    for (unsigned int t = 0; t < workers.size(); t++)
+        workers[t].join();
+    close(listener);
+    unlink(socket_filename.c_str());
+    for (unsigned int c = 0; c < server.connections.size(); c++)
+        close(server.connections[c]);
+    print_comparer_stats(comparers);
+}
@@ -0,0 +1,40 @@
+#include "genome_grouping_common.h"
+
+std::string shard_filename(const std::string &filename, int shard) {
+    return filename + ".shard" + std::to_string(shard);
+}
+
+/**
+ *The shards are consecutive ranges of the pairs in the order a single run writes them, so merging them in that order
+ *is writing each one after the previous.
+ */
+void merge_shards(const std::string &method, const std::string &genome_sim_filename,
+                  const std::string &pairings_filename, int shards) {
+    if (genome_sim_filename == "-") {
+        std::cerr << "ERROR: merging shards requires an output filename\n";
+        exit(1);
+    }
+    std::vector<method_output_t> outputs = open_method_outputs(method, genome_sim_filename, pairings_filename);
+
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        std::string suffix = outputs.size() > 1 ? "." + outputs[k].method : "";
+        for (int shard = 0; shard < shards; shard++) {
+            std::ifstream output_shard((shard_filename(genome_sim_filename, shard) + suffix).c_str());
+            if (output_shard.fail()) {
+                std::cerr << "ERROR: trouble opening " << shard_filename(genome_sim_filename, shard) + suffix << "\n";
+                exit(1);
+            }
+            if (output_shard.peek() != EOF)
+                outputs[k].output_file << output_shard.rdbuf();
+            if (pairings_filename == "&") continue;
+
+            std::ifstream pairings_shard((shard_filename(pairings_filename, shard) + suffix).c_str());
+            if (pairings_shard.fail()) {
+                std::cerr << "ERROR: trouble opening " << shard_filename(pairings_filename, shard) + suffix << "\n";
+                exit(1);
+            }
+            if (pairings_shard.peek() != EOF)
+                outputs[k].pairings_file << pairings_shard.rdbuf();
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "genome_grouping_common.h"
+
+/**
+ *Neighborhoods read from a stream by genome_clustering_stream, with what is kept to compare the next ones
+ */
+typedef struct {
+    NeighborhoodStore neighborhoods;
+    std::vector<pair_comparer_t> *comparers;
+    std::string pairings_filename;
+    int min_proteins;
+    int seed_window;
+    bool candidates_only;  //compares each neighborhood only with the ones with a protein similar to one of it
+
+    neighborhood_index_t index;                      //of the compared neighborhoods
+    std::vector<unsigned int> stamps;                //last neighborhood (+ 1) each neighborhood is a candidate of
+    std::vector<unsigned int> compared;              //neighborhoods with enough proteins for some method
+    unsigned int scored;                             //neighborhoods already compared with the previous ones
+
+    std::vector<unsigned int> candidates;
+    std::vector<std::pair<unsigned int, unsigned int> > pairs;
+    std::vector<std::vector<std::string> > results;
+} neighborhood_stream_t;
+
+/**
+ *Receives a ProteinCollection and sets the proteins similar to each of its proteins, in both directions (see
+ *neighborhood_index_t)
+ */
+void similar_proteins(ProteinCollection &clusters, std::vector<unsigned long long> &offsets,
+                      std::vector<int> &similar) {
+    offsets.assign(clusters.size() + 1, 0);
+    for (size_t x = 0; x < clusters.size(); x++) {
+        const std::unordered_map<int, double> &lower = clusters.lower_neighbors(x);
+        for (std::unordered_map<int, double>::const_iterator it = lower.begin(); it != lower.end(); ++it) {
+            offsets[x + 1]++;
+            if (it->first != (int)x)
+                offsets[it->first + 1]++;
+        }
+    }
+    for (size_t x = 0; x < clusters.size(); x++)
+        offsets[x + 1] += offsets[x];
+
+    similar.resize(offsets.back());
+    std::vector<unsigned long long> next(offsets.begin(), offsets.end() - 1);
+    for (size_t x = 0; x < clusters.size(); x++) {
+        const std::unordered_map<int, double> &lower = clusters.lower_neighbors(x);
+        for (std::unordered_map<int, double>::const_iterator it = lower.begin(); it != lower.end(); ++it) {
+            similar[next[x]++] = it->first;
+            if (it->first != (int)x)
+                similar[next[it->first]++] = x;
+        }
+    }
+}
+
+/**
+ *Adds neighborhood n (resolved in the ProteinCollection of the index) to the index
+ */
+void index_neighborhood(neighborhood_index_t &index, NeighborhoodStore &neighborhoods, unsigned int n) {
+    const long *indexes = neighborhoods.protein_indexes(n);
+    for (int i = 0; i < neighborhoods.protein_count(n); i++) {
+        if (indexes[i] < 0) continue;
+        std::vector<unsigned int> &with_protein = index.neighborhoods_of[indexes[i]];
+        if (with_protein.empty() || with_protein.back() != n)
+            with_protein.push_back(n);
+    }
+}
+
+/**
+ *Receives the ProteinCollection indexes of the proteins of a neighborhood and a stamp different from the ones of
+ *the previous calls with the same stamps (one for each indexed neighborhood).
+ *Appends the indexed neighborhoods with a protein similar to one of it to candidates, each one once, sorted
+ */
+void candidate_neighborhoods(const neighborhood_index_t &index, const long *indexes, int count,
+                             std::vector<unsigned int> &stamps, unsigned int stamp,
+                             std::vector<unsigned int> &candidates) {
+    size_t first = candidates.size();
+    for (int i = 0; i < count; i++) {
+        if (indexes[i] < 0) continue;
+        for (unsigned long long s = index.similar_offsets[indexes[i]]; s < index.similar_offsets[indexes[i] + 1]; s++) {
+            const std::vector<unsigned int> &with_protein = index.neighborhoods_of[index.similar[s]];
+            for (unsigned int c = 0; c < with_protein.size(); c++)
+                if (stamps[with_protein[c]] != stamp) {
+                    stamps[with_protein[c]] = stamp;
+                    candidates.push_back(with_protein[c]);
+                }
+        }
+    }
+    std::sort(candidates.begin() + first, candidates.end());
+}
+
+/**
+ *Compares neighborhood n of the stream with the previous ones (its candidates or all of them) and writes the results
+ *of the pairs in their order, flushing the outputs.
+ */
+static void score_neighborhood(neighborhood_stream_t &stream, result_cache_t &cache, unsigned int n) {
+    NeighborhoodStore &neighborhoods = stream.neighborhoods;
+    std::vector<pair_comparer_t> &comparers = *stream.comparers;
+    std::vector<method_output_t> &outputs = *comparers[0].outputs;
+
+    //Every neighborhood is its own class: the results of identical ones are not kept
+    cache.classes.push_back(n);
+    cache.last_member.push_back(n);
+    cache.next_member.push_back(n);
+    stream.stamps.push_back(0);
+
+    if (stream.seed_window >= 0)
+        neighborhoods.set_seed_window(stream.seed_window, n, n + 1);
+    neighborhoods.resolve(*comparers[0].clusters, n, n + 1);
+    if (neighborhoods.protein_count(n) < stream.min_proteins) return;
+
+    stream.candidates.clear();
+    if (stream.candidates_only)
+        candidate_neighborhoods(stream.index, neighborhoods.protein_indexes(n), neighborhoods.protein_count(n),
+                                stream.stamps, n + 1, stream.candidates);
+    stream.pairs.clear();
+    const std::vector<unsigned int> &previous = stream.candidates_only ? stream.candidates : stream.compared;
+    for (unsigned int c = 0; c < previous.size(); c++)
+        stream.pairs.push_back(std::make_pair(previous[c], n));
+
+    compare_pairs(comparers, neighborhoods, stream.pairs.data(), stream.pairs.size(), stream.pairings_filename,
+                  stream.results);
+    for (unsigned int i = 0; i < stream.results.size(); i++)
+        for (unsigned int k = 0; k < outputs.size(); k++) {
+            outputs[k].output_file << stream.results[i][2*k];
+            outputs[k].pairings_file << stream.results[i][2*k + 1];
+        }
+    for (unsigned int k = 0; k < outputs.size(); k++) {
+        outputs[k].output_file.flush();
+        outputs[k].pairings_file.flush();
+    }
+
+    index_neighborhood(stream.index, neighborhoods, n);
+    stream.compared.push_back(n);
+}
+
+/**
+ *A neighborhood is compared when the line that starts the next one, an empty line or the end of the stream is read.
+ *Pairs without a similarity between their proteins score 0, so above a neighborhood stringency of 0 only the previous
+ *neighborhoods with a protein similar to one of the new neighborhood (found with an index of the neighborhoods of
+ *each protein) are compared with it; otherwise, all of them are.
+ */
+void genome_clustering_stream(std::istream &input, ProteinCollection &clusters, const std::string &method,
+                              double prot_stringency, double neigh_stringency, const std::string &genome_sim_filename,
+                              const std::string &pairings_filename, const clustering_options_t &options) {
+    std::vector<method_output_t> outputs = open_method_outputs(method, genome_sim_filename, pairings_filename);
+    bool has_porthodom;
+    int min_proteins = min_method_proteins(outputs, has_porthodom);
+
+    result_cache_t cache;
+    std::vector<pair_comparer_t> comparers(std::max(options.threads, 1));
+    init_comparers(comparers, outputs, &clusters, prot_stringency, neigh_stringency, options, has_porthodom, cache);
+
+    neighborhood_stream_t stream;
+    stream.comparers = &comparers;
+    stream.pairings_filename = pairings_filename;
+    stream.min_proteins = min_proteins;
+    stream.seed_window = options.seed_window;
+    stream.candidates_only = neigh_stringency > 0;
+    if (stream.candidates_only)
+        similar_proteins(clusters, stream.index.similar_offsets, stream.index.similar);
+    stream.index.neighborhoods_of.resize(clusters.size());
+    stream.scored = 0;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        NeighborhoodStore &neighborhoods = stream.neighborhoods;
+        //After an empty line, the lines before the next neighborhood are ignored
+        if (stream.scored == neighborhoods.size() && line.find("ORGANISM") == std::string::npos) continue;
+
+        unsigned int end = stream.scored; //neighborhoods ended by the line
+        if (neighborhoods.add_line(line))
+            end = neighborhoods.size() - 1;
+        else if (line.find_first_not_of(" \t\r") == std::string::npos)
+            end = neighborhoods.size();
+        for (; stream.scored < end; stream.scored++)
+            score_neighborhood(stream, cache, stream.scored);
+    }
+    for (; stream.scored < stream.neighborhoods.size(); stream.scored++)
+        score_neighborhood(stream, cache, stream.scored);
+
+    std::cerr << "Neighborhoods read from the stream: " << stream.neighborhoods.size() << "\n";
+    print_comparer_stats(comparers);
+}
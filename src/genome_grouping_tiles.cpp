@@ -0,0 +1,162 @@
+#include "genome_grouping_common.h"
+
+#ifdef USE_MPI
+#define TAG_RESULTS 1 //worker -> rank 0: results of a tile (after asking for the first one)
+#define TAG_TILE 2    //rank 0 -> worker: next tile to compare, or none
+
+/**
+ *Sends or receives the bytes of a string, in pieces whose size fits in an int
+ */
+static void send_bytes(const std::string &bytes, int rank) {
+    for (size_t sent = 0; sent < bytes.size(); sent += 1 << 30)
+        MPI_Send(bytes.data() + sent, (int)std::min(bytes.size() - sent, (size_t)1 << 30), MPI_BYTE, rank, TAG_RESULTS,
+                 MPI_COMM_WORLD);
+}
+
+static void receive_bytes(std::string &bytes, int rank) {
+    for (size_t received = 0; received < bytes.size(); received += 1 << 30)
+        MPI_Recv(&bytes[received], (int)std::min(bytes.size() - received, (size_t)1 << 30), MPI_BYTE, rank, TAG_RESULTS,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+
+/**
+ *Rank 0 of genome_clustering_mpi: hands out the tiles of the pairs to the workers as they ask for them, and writes
+ *their results in the order of the tiles
+ */
+static void coordinate_tiles(NeighborhoodStore &neighborhoods, std::vector<method_output_t> &outputs, int min_proteins,
+                             unsigned int first_column, unsigned int rows_end, int ranks) {
+    std::vector<unsigned long long> tiles = split_pairs(neighborhoods, min_proteins, first_column, rows_end,
+                                                        TILES_PER_WORKER*(ranks - 1));
+    std::map<unsigned long long, std::vector<std::string> > done; //results of tiles waiting for the previous ones
+    unsigned long long next_tile = 0, next_written = 0;
+    std::vector<unsigned long long> header(1 + 2*outputs.size());
+
+    for (int working = ranks - 1; working > 0; ) {
+        MPI_Status status;
+        MPI_Recv(header.data(), header.size(), MPI_UNSIGNED_LONG_LONG, MPI_ANY_SOURCE, TAG_RESULTS, MPI_COMM_WORLD, &status);
+        if (header[0] != ~0ULL) { //results of a tile, not the first request of the worker
+            std::vector<std::string> &results = done[header[0]];
+            results.resize(2*outputs.size());
+            for (unsigned int k = 0; k < results.size(); k++) {
+                results[k].resize(header[1 + k]);
+                receive_bytes(results[k], status.MPI_SOURCE);
+            }
+        }
+
+        unsigned long long tile[3] = {~0ULL, 0, 0};
+        if (next_tile + 1 < tiles.size()) {
+            tile[0] = next_tile;
+            tile[1] = tiles[next_tile];
+            tile[2] = tiles[next_tile + 1];
+            next_tile++;
+        }
+        else
+            working--;
+        MPI_Send(tile, 3, MPI_UNSIGNED_LONG_LONG, status.MPI_SOURCE, TAG_TILE, MPI_COMM_WORLD);
+
+        for (std::map<unsigned long long, std::vector<std::string> >::iterator it = done.find(next_written);
+             it != done.end(); it = done.find(++next_written)) {
+            for (unsigned int k = 0; k < outputs.size(); k++) {
+                outputs[k].output_file << it->second[2*k];
+                outputs[k].pairings_file << it->second[2*k + 1];
+            }
+            done.erase(it);
+        }
+    }
+    std::cerr << "Tiles of pairs handed out to " << ranks - 1 << " ranks: " << tiles.size() - 1 << "\n";
+}
+
+/**
+ *The workers compare their tiles as genome_clustering compares all the pairs, with the outputs written to buffers
+ *that are sent to rank 0 after each tile.
+ */
+void genome_clustering_mpi(NeighborhoodStore &neighborhoods, ProteinCollection &clusters,
+                           const std::string &method, double prot_stringency, double neigh_stringency,
+                           const std::string &genome_sim_filename, const std::string &pairings_filename,
+                           const clustering_options_t &options) {
+    int rank, ranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+    std::vector<method_output_t> outputs = rank == 0 ? open_method_outputs(method, genome_sim_filename, pairings_filename,
+                                                                           options.first_new > 0)
+                                                     : method_outputs(method);
+    bool has_porthodom;
+    int min_proteins = min_method_proteins(outputs, has_porthodom);
+    if (options.seed_window >= 0)
+        neighborhoods.set_seed_window(options.seed_window);
+
+    unsigned int rows_end = options.first_reference > 0 ? options.first_reference : neighborhoods.size();
+    unsigned int first_column = std::max(options.first_new, options.first_reference);
+
+    clustering_stats_t stats = clustering_stats_t(), total = clustering_stats_t();
+    if (rank == 0)
+        coordinate_tiles(neighborhoods, outputs, min_proteins, first_column, rows_end, ranks);
+
+    else {
+        neighborhoods.resolve(clusters);
+        result_cache_t cache;
+        fill_result_cache(cache, neighborhoods, options.seed_anchor, options.first_reference);
+
+        std::vector<std::stringbuf> buffers(2*outputs.size());
+        for (unsigned int k = 0; k < outputs.size(); k++) {
+            outputs[k].output_file.basic_ios<char>::rdbuf(&buffers[2*k]);
+            outputs[k].pairings_file.basic_ios<char>::rdbuf(&buffers[2*k + 1]);
+        }
+
+        row_queue_t queue;
+        queue.neighborhoods = &neighborhoods;
+        queue.outputs = &outputs;
+        queue.pairings_filename = pairings_filename;
+        queue.min_proteins = min_proteins;
+        queue.group_of.assign(neighborhoods.size(), -1);
+        queue.row_buffers.resize(neighborhoods.size());
+        queue.rows_end = rows_end;
+        queue.columns_begin = first_column;
+        queue.columns_end = neighborhoods.size();
+        queue.checkpoint = NULL;
+
+        std::vector<pair_comparer_t> comparers(std::max(options.threads, 1));
+        init_comparers(comparers, outputs, &clusters, prot_stringency, neigh_stringency, options, has_porthodom, cache);
+
+        //Asks for a tile with the results of the previous one, until there are none left
+        std::vector<unsigned long long> header(1 + 2*outputs.size(), 0);
+        std::vector<std::string> results(buffers.size());
+        unsigned long long tile[3] = {~0ULL, 0, 0};
+        do {
+            header[0] = tile[0];
+            MPI_Send(header.data(), header.size(), MPI_UNSIGNED_LONG_LONG, 0, TAG_RESULTS, MPI_COMM_WORLD);
+            for (unsigned int k = 0; tile[0] != ~0ULL && k < results.size(); k++)
+                send_bytes(results[k], 0);
+            MPI_Recv(tile, 3, MPI_UNSIGNED_LONG_LONG, 0, TAG_TILE, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            if (tile[0] == ~0ULL) break;
+
+            queue.pairs_begin = tile[1];
+            queue.pairs_end = tile[2];
+            queue.rows.clear();
+            for (unsigned int m = 0; m < rows_end; m++) {
+                unsigned int columns_begin, columns_end;
+                row_columns(queue, m, columns_begin, columns_end);
+                if (neighborhoods.protein_count(m) >= min_proteins && columns_begin < columns_end)
+                    queue.rows.push_back(m);
+            }
+            compare_queue(comparers, queue);
+            cache.results.clear(); //the next tile may not have the rest of the pairs of their classes
+
+            for (unsigned int k = 0; k < buffers.size(); k++) {
+                results[k] = buffers[k].str();
+                buffers[k].str("");
+                header[1 + k] = results[k].size();
+            }
+        } while (true);
+
+        for (unsigned int t = 0; t < comparers.size(); t++)
+            add_stats(stats, comparers[t].stats);
+    }
+
+    //The statistics of the workers are added up at rank 0
+    MPI_Reduce(&stats, &total, sizeof(stats)/sizeof(unsigned long long), MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0)
+        print_stats(total);
+}
+#endif
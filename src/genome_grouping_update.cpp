@@ -0,0 +1,274 @@
+#include "genome_grouping_common.h"
+
+/**
+ *Receives a store of genomic neighborhoods.
+ *Returns the proteins of the neighborhoods (by their packed pid), numbered in order of first appearance, and sets
+ *the position of the first appearance of each of them among the proteins of the store and the neighborhoods each of
+ *them is in, from protein_offsets[p] to protein_offsets[p + 1] - 1 of protein_neighborhoods (an index of the
+ *neighborhoods by protein).
+ */
+static HashTable neighborhood_proteins(NeighborhoodStore &neighborhoods, std::vector<unsigned int> &first_positions,
+                                       std::vector<unsigned int> &protein_offsets,
+                                       std::vector<unsigned int> &protein_neighborhoods) {
+    HashTable proteins;
+    std::vector<std::pair<int, unsigned int> > memberships; //(protein, neighborhood)
+    first_positions.clear();
+    for (unsigned int n = 0; n < neighborhoods.size(); n++)
+        for (int i = 0; i < neighborhoods.protein_count(n); i++) {
+            unsigned int position = neighborhoods.first_protein(n) + i;
+            int p = proteins.insert(neighborhoods.pid_key(position));
+            if (p == (int)first_positions.size())
+                first_positions.push_back(position);
+            memberships.push_back(std::make_pair(p, n));
+        }
+    std::sort(memberships.begin(), memberships.end());
+    memberships.erase(std::unique(memberships.begin(), memberships.end()), memberships.end());
+
+    protein_offsets.assign(proteins.size() + 1, 0);
+    protein_neighborhoods.clear();
+    for (unsigned int k = 0; k < memberships.size(); k++) {
+        protein_offsets[memberships[k].first + 1]++;
+        protein_neighborhoods.push_back(memberships[k].second);
+    }
+    for (unsigned int p = 0; p < proteins.size(); p++)
+        protein_offsets[p + 1] += protein_offsets[p];
+    return proteins;
+}
+
+/**
+ *Receives a compiled graph, the position of each of its proteins among the proteins of the neighborhoods (-1 if
+ *not in them) and one of its proteins.
+ *Returns the similarities of the protein to the proteins of the neighborhoods, as (position, similarity), sorted.
+ */
+static std::vector<std::pair<int, double> > neighborhood_similarities(const CompiledGraph &graph,
+                                                                      std::vector<int> &positions, long id) {
+    std::vector<std::pair<int, double> > similarities;
+    if (id < 0) return similarities;
+    const unsigned int *neighbors = graph.neighbors_of(id);
+    const double *weights = graph.weights_of(id);
+    for (long k = 0; k < graph.degree(id); k++)
+        if (positions[neighbors[k]] >= 0)
+            similarities.push_back(std::make_pair(positions[neighbors[k]], weights[k]));
+    std::sort(similarities.begin(), similarities.end());
+    return similarities;
+}
+
+/**
+ *Receives a store of genomic neighborhoods and the compiled graphs of the previous and the new similarities.
+ *Returns the pairs of neighborhoods (m, n), m < n, in the order they are compared, with the two proteins of a
+ *similarity that changed (added, removed or with a different value), one in each of them. Sets changes to the
+ *number of similarities that changed.
+ */
+static std::vector<std::pair<unsigned int, unsigned int> > changed_pairs(NeighborhoodStore &neighborhoods,
+                                                                         const CompiledGraph &previous_graph,
+                                                                         const CompiledGraph &graph,
+                                                                         unsigned long long &changes) {
+    std::vector<unsigned int> first_positions, protein_offsets, protein_neighborhoods;
+    HashTable proteins = neighborhood_proteins(neighborhoods, first_positions, protein_offsets, protein_neighborhoods);
+
+    //Only the similarities between proteins of the neighborhoods matter
+    std::vector<int> previous_positions(previous_graph.protein_count(), -1), positions(graph.protein_count(), -1);
+    std::vector<long> previous_ids(proteins.size()), ids(proteins.size());
+    std::string pid;
+    for (unsigned int p = 0; p < proteins.size(); p++) {
+        pid.clear();
+        neighborhoods.append_pid(pid, first_positions[p]);
+        previous_ids[p] = previous_graph.find(pid);
+        ids[p] = graph.find(pid);
+        if (previous_ids[p] >= 0) previous_positions[previous_ids[p]] = p;
+        if (ids[p] >= 0) positions[ids[p]] = p;
+    }
+
+    std::vector<std::pair<unsigned int, unsigned int> > pairs;
+    changes = 0;
+    for (unsigned int p = 0; p < proteins.size(); p++) {
+        std::vector<std::pair<int, double> > before = neighborhood_similarities(previous_graph, previous_positions, previous_ids[p]);
+        std::vector<std::pair<int, double> > after = neighborhood_similarities(graph, positions, ids[p]);
+        std::vector<std::pair<int, double> > changed;
+        std::set_symmetric_difference(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(changed));
+
+        for (unsigned int c = 0; c < changed.size(); c++) {
+            unsigned int q = changed[c].first;
+            if (q < p || (c > 0 && changed[c - 1].first == (int)q)) continue; //each similarity once
+            changes++;
+            for (unsigned int i = protein_offsets[p]; i < protein_offsets[p + 1]; i++)
+                for (unsigned int j = protein_offsets[q]; j < protein_offsets[q + 1]; j++) {
+                    unsigned int m = protein_neighborhoods[i], n = protein_neighborhoods[j];
+                    if (m != n)
+                        pairs.push_back(std::make_pair(std::min(m, n), std::max(m, n)));
+                }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+}
+
+/**
+ *An output or pairings file being patched by genome_clustering_update: its records (the line of a pair in an output
+ *file, the '>' line of a pair and its pairings in a pairings file) are read in order and copied to the patched file,
+ *except the ones of the pairs compared again
+ */
+typedef struct {
+    std::string filename;
+    bool pairings;
+    std::ifstream previous;
+    std::ofstream patched;     //written to filename followed by ".update", renamed over it at the end
+    std::string record;        //next record of previous...
+    unsigned long long pair;   //...and the triangle index of its pair, ~0 at the end of the file
+} patched_file_t;
+
+/**
+ *Receives a file being patched, a store of genomic neighborhoods and the neighborhoods of each accession and
+ *coordinates (see append_neighborhood).
+ *Reads the next record of the file and finds its pair: among the pairs of neighborhoods with its accessions and
+ *coordinates, the first one after the pair of the previous record (the records are in the order of the pairs).
+ */
+static void read_record(patched_file_t &file, NeighborhoodStore &neighborhoods,
+                        std::unordered_map<std::string, std::vector<unsigned int> > &neighborhoods_of) {
+    std::string line;
+    file.record.clear();
+    if (!std::getline(file.previous, line)) {
+        file.pair = ~0ULL;
+        return;
+    }
+    std::vector<std::string> fields = split(line.substr(file.pairings), "\t");
+    file.record = line + '\n';
+    while (file.pairings && file.previous.peek() != '>' && std::getline(file.previous, line))
+        file.record += line + '\n';
+
+    std::unordered_map<std::string, std::vector<unsigned int> >::iterator first, second;
+    if (fields.size() < 6 ||
+        (first = neighborhoods_of.find(fields[0] + '\t' + fields[1] + '\t' + fields[2])) == neighborhoods_of.end() ||
+        (second = neighborhoods_of.find(fields[3] + '\t' + fields[4] + '\t' + fields[5])) == neighborhoods_of.end()) {
+        std::cerr << "ERROR: " << file.filename << " has pairs that are not in the neighborhoods file\n";
+        exit(1);
+    }
+
+    unsigned long long count = neighborhoods.size(), previous = file.pair, found = ~0ULL, after = ~0ULL;
+    for (unsigned int i = 0; i < first->second.size(); i++)
+        for (unsigned int j = 0; j < second->second.size(); j++) {
+            unsigned int m = first->second[i], n = second->second[j];
+            if (m >= n) continue;
+            unsigned long long pair = triangle_index(m, n, count);
+            found = std::min(found, pair);
+            if (previous == ~0ULL || pair > previous)
+                after = std::min(after, pair);
+        }
+    if (found == ~0ULL) {
+        std::cerr << "ERROR: " << file.filename << " has pairs that are not in the neighborhoods file\n";
+        exit(1);
+    }
+    file.pair = after != ~0ULL ? after : found;
+}
+
+/**
+ *The changed pairs are compared in batches, with a thread for each comparer, on a ProteinCollection with only the
+ *proteins of their neighborhoods. The results of each batch are written in the place of the records of its pairs,
+ *between the records copied from the previous outputs, so the patched outputs are the ones of a run on the new
+ *similarities.
+ */
+void genome_clustering_update(NeighborhoodStore &neighborhoods, const CompiledGraph &previous_graph,
+                              const CompiledGraph &graph, bool normalize, const std::string &method,
+                              double prot_stringency, double neigh_stringency, const std::string &genome_sim_filename,
+                              const std::string &pairings_filename, const clustering_options_t &options) {
+    if (normalize && previous_graph.max_similarity() != graph.max_similarity()) {
+        std::cerr << "ERROR: the largest similarity changed, so every normalized similarity did: compare all the"
+                  << " neighborhoods again\n";
+        exit(1);
+    }
+    std::vector<method_output_t> outputs = method_outputs(method);
+    bool has_porthodom;
+    int min_proteins = min_method_proteins(outputs, has_porthodom);
+
+    if (options.seed_window >= 0)
+        neighborhoods.set_seed_window(options.seed_window);
+
+    unsigned long long changes;
+    std::vector<std::pair<unsigned int, unsigned int> > pairs = changed_pairs(neighborhoods, previous_graph, graph, changes);
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [&neighborhoods, min_proteins](const std::pair<unsigned int, unsigned int> &pair) {
+        return neighborhoods.protein_count(pair.first) < min_proteins || neighborhoods.protein_count(pair.second) < min_proteins;
+    }), pairs.end());
+    std::cerr << "Similarities changed: " << changes << "\n"
+              << "Pairs of neighborhoods compared again: " << pairs.size() << "\n";
+
+    //Identical neighborhoods are found by the graph ids of their proteins
+    neighborhoods.resolve(graph, 0, neighborhoods.size());
+    result_cache_t cache;
+    fill_result_cache(cache, neighborhoods, options.seed_anchor, options.first_reference);
+
+    graph_block_t block;
+    std::vector<bool> compared(neighborhoods.size(), false);
+    for (unsigned int i = 0; i < pairs.size(); i++)
+        compared[pairs[i].first] = compared[pairs[i].second] = true;
+    for (unsigned int n = 0; n < neighborhoods.size(); n++) {
+        const long *ids = neighborhoods.protein_indexes(n);
+        for (int i = 0; compared[n] && i < neighborhoods.protein_count(n); i++)
+            if (ids[i] >= 0)
+                block.ids.push_back(ids[i]);
+    }
+    load_block_ids(graph, block);
+    ProteinCollection clusters = block_pair_collection(graph, block, block, normalize);
+    neighborhoods.resolve(clusters, 0, neighborhoods.size());
+
+    //The output and pairings file of the k-th method at 2k and 2k + 1
+    std::vector<patched_file_t> files(2*outputs.size());
+    std::unordered_map<std::string, std::vector<unsigned int> > neighborhoods_of;
+    for (unsigned int n = 0; n < neighborhoods.size(); n++) {
+        std::string key;
+        append_neighborhood(key, GenomicNeighborhood(neighborhoods, n));
+        neighborhoods_of[key].push_back(n);
+    }
+    for (unsigned int f = 0; f < files.size(); f++) {
+        std::string suffix = outputs.size() > 1 ? "." + outputs[f/2].method : "";
+        if (f % 2 == 1 && pairings_filename == "&") continue;
+        files[f].filename = (f % 2 == 0 ? genome_sim_filename : pairings_filename) + suffix;
+        files[f].pairings = f % 2 == 1;
+        files[f].previous.open(files[f].filename.c_str());
+        files[f].patched.open((files[f].filename + ".update").c_str());
+        if (files[f].previous.fail() || files[f].patched.fail()) {
+            std::cerr << "ERROR: trouble opening " << files[f].filename << " or its update\n";
+            exit(1);
+        }
+        files[f].pair = ~0ULL;
+        read_record(files[f], neighborhoods, neighborhoods_of);
+    }
+
+    std::vector<pair_comparer_t> comparers(std::max(options.threads, 1));
+    init_comparers(comparers, outputs, &clusters, prot_stringency, neigh_stringency, options, has_porthodom, cache);
+    std::vector<unsigned long long> indexes; //triangle indexes of the pairs
+    for (unsigned int i = 0; i < pairs.size(); i++)
+        indexes.push_back(triangle_index(pairs[i].first, pairs[i].second, neighborhoods.size()));
+
+    std::vector<std::vector<std::string> > results;
+    for (size_t begin = 0; begin < pairs.size(); begin += UPDATE_BATCH_PAIRS) {
+        size_t size = std::min(pairs.size() - begin, (size_t)UPDATE_BATCH_PAIRS);
+        compare_pairs(comparers, neighborhoods, &pairs[begin], size, pairings_filename, results);
+        cache.results.clear();
+
+        //The results of each pair are written after the records of the pairs before it, in place of its own record.
+        //The records of the pairs compared again are dropped, even out of order (e.g. after an incremental run)
+        for (size_t i = 0; i < size; i++) {
+            for (unsigned int f = 0; f < files.size(); f++) {
+                if (files[f].filename.empty()) continue;
+                for (; files[f].pair <= indexes[begin + i]; read_record(files[f], neighborhoods, neighborhoods_of))
+                    if (!std::binary_search(indexes.begin(), indexes.end(), files[f].pair))
+                        files[f].patched << files[f].record;
+                files[f].patched << results[i][f];
+            }
+        }
+    }
+
+    for (unsigned int f = 0; f < files.size(); f++) {
+        if (files[f].filename.empty()) continue;
+        for (; files[f].pair != ~0ULL; read_record(files[f], neighborhoods, neighborhoods_of))
+            if (!std::binary_search(indexes.begin(), indexes.end(), files[f].pair))
+                files[f].patched << files[f].record;
+        files[f].patched.close();
+        if (files[f].patched.fail() || std::rename((files[f].filename + ".update").c_str(), files[f].filename.c_str()) != 0) {
+            std::cerr << "ERROR: trouble writing " << files[f].filename << "\n";
+            exit(1);
+        }
+    }
+    print_comparer_stats(comparers);
+}
@@ -6,23 +6,87 @@
 #include "ProteinCollection.h"
 #include "cxxopts.hpp"
 
+/**
+ *Returns the MPI rank of the process and the number of ranks (0 and 1 if not built with MPI)
+ */
+static int mpi_rank() {
+	int rank = 0;
+#ifdef USE_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+	return rank;
+}
 
-int main(int argc, char *argv[]) {
+static int mpi_ranks() {
+	int ranks = 1;
+#ifdef USE_MPI
+	MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+#endif
+	return ranks;
+}
+
+/**
+ *Receives a similarities file, compiled or in text.
+ *Returns the filename of its compiled graph: the file itself, or the text compiled to it followed by ".graph"
+ */
+static std::string compiled_graph(const std::string &prot_sim_filename) {
+	if (CompiledGraph::is_compiled(prot_sim_filename))
+		return prot_sim_filename;
+	std::string graph_filename = prot_sim_filename + ".graph";
+	std::cout << "\nCompiling protein similarities to " << graph_filename << "...\n";
+	CompiledGraph::compile(prot_sim_filename, graph_filename);
+	return graph_filename;
+}
+
+/**
+ *Compares the neighborhoods in blocks, under the memory budget of the options, with the similarities of a compiled
+ *graph (see compiled_graph).
+ */
+static void blocked_clustering(NeighborhoodStore &neighborhoods, const std::string &prot_sim_filename, bool normalize,
+                               const std::string &neigh_comparing, double prot_stringency, double neigh_stringency,
+                               const std::string &output, const std::string &pairings_filename,
+                               const clustering_options_t &clustering_options) {
+	CompiledGraph graph;
+	graph.open(compiled_graph(prot_sim_filename));
+
+	std::cout << "\nClustering genomic neighborhoods in blocks...\n";
+	genome_clustering_blocked(neighborhoods, graph, normalize, neigh_comparing, prot_stringency, neigh_stringency, output,
+	                          pairings_filename, clustering_options);
+}
+
+static int run(int argc, char *argv[]) {
 	/*Main program, coordinates all the modes of execution calling the apropriate functions*/
 
 	/*Dealing with command line arguments*/
 	cxxopts::Options options("neighborhood_comparer", "genomic neighborhood comparison software");
 	options.add_options()
 		("h, help", "Prints help message")
-		("e,execution_mode", "full or partial execution mode (default: full)", cxxopts::value<std::string>()->default_value("full"))
-		("n,neighborhoods_filename", "File containing the genomic neighborhoods", cxxopts::value<std::string>())
+		("e,execution_mode", "full, partial, compile, append, compact, merge, update, serve, index or query execution mode (default: full)", cxxopts::value<std::string>()->default_value("full"))
+		("n,neighborhoods_filename", "File containing the genomic neighborhoods (- to read them from stdin, comparing each one as it arrives)", cxxopts::value<std::string>())
 		("s,prot_sim_filename", "File containing pairs of proteins and their similarities", cxxopts::value<std::string>())
-		("l,normalize_prot_sim", "Indicates that the protein similarities file should be normalized (Used in the partial execution mode)")
+		("l,normalize_prot_sim", "Indicates that the protein similarities file should be normalized (Used in the partial, update, serve and query execution modes)")
 		("f,formatted_prot_filename", "File already formatted as the input for the homology detection method", cxxopts::value<std::string>())
 		("p,protein_comparing", "Method for comparing proteins (default: nc)", cxxopts::value<std::string>()->default_value("nc"))
 		("t,prot_stringency", "Minimum similarity required to treat two proteins as a related pair", cxxopts::value<double>()->default_value("0.0"))
 		("r,neigh_stringency", "Minimum threshold to display the similarity between two neighborhoods", cxxopts::value<double>()->default_value("0.0"))
-		("g,neigh_comparing","Method for comparing genomic neighborhoods (default: porthodom method)", cxxopts::value<std::string>()->default_value("porthodom"))
+		("g,neigh_comparing","Methods for comparing genomic neighborhoods, separated by commas (default: porthodom method)", cxxopts::value<std::string>()->default_value("porthodom"))
+		("gap_penalty", "Penalty of each protein left unpaired inside a colinear alignment", cxxopts::value<double>()->default_value("0.0"))
+		("colinear_reverse", "Also aligns the neighborhoods in reverse order in the colinear method")
+		("overlapping_windows", "Compares overlapping neighborhoods of the same accession together, sharing their similarities")
+		("seed_window", "Compares only this many proteins on each side of the seeds of the neighborhoods (default: whole neighborhoods)", cxxopts::value<int>()->default_value("-1"))
+		("seed_anchor", "Pairs the seeds of the neighborhoods and matches the proteins on each side of them separately in the porthodom method")
+		("j,threads", "Number of threads comparing neighborhoods", cxxopts::value<int>()->default_value("1"))
+		("memory_budget", "Compares the neighborhoods in blocks whose protein similarities fit in this many MB (default: all at once)", cxxopts::value<int>()->default_value("0"))
+		("shard", "Compares only the i-th of N shards of the pairs of neighborhoods, written to the output filenames followed by .shard<i> (format: i/N, i from 0 to N - 1); in merge mode, N", cxxopts::value<std::string>())
+		("checkpoint", "Saves a checkpoint of the outputs every this many seconds (and when terminated) to the output filename followed by .ckpt (default: no checkpoints)", cxxopts::value<int>()->default_value("0"))
+		("resume", "Continues the run from the checkpoint of its output, if there is one")
+		("incremental", "Compares only the neighborhoods that are not in the previous neighborhoods file, adding their pairs to the outputs")
+		("previous", "Neighborhoods file of the previous results (the first neighborhoods of the neighborhoods file), for --incremental; in update mode, the protein similarities of the previous results", cxxopts::value<std::string>())
+		("reference", "File containing reference genomic neighborhoods: only the pairs of a neighborhood of the neighborhoods file (a query) and a reference are compared", cxxopts::value<std::string>())
+		("socket", "Unix domain socket the serve execution mode answers requests on", cxxopts::value<std::string>())
+		("q,query", "File containing the genomic neighborhoods compared with an index in the query execution mode", cxxopts::value<std::string>())
+		("index", "Neighborhood index file the query execution mode compares the neighborhoods with", cxxopts::value<std::string>())
+		("top", "Number of best partners written for each neighborhood in the query execution mode (default: all)", cxxopts::value<int>()->default_value("0"))
 		("o,output", "Where the neighborhood similarities should be written", cxxopts::value<std::string>()->default_value("-"))
 		("a,pairings_filename", "Where the chosen pairings between proteins in the neighborhoods should be written", cxxopts::value<std::string>()->default_value("&"))
 		;
@@ -34,7 +98,7 @@ int main(int argc, char *argv[]) {
 		std::cout << "HOW TO RUN:\n"
 				<< "  - 1: ./make\n"
 				<<"  - 2: ./python parse_neighborhood.py <file with neighborhoods>\n"
-				<<"  - 3: ./neighborhood_comparer <full or partial> <args according to chosen mode>\n\n"
+				<<"  - 3: ./neighborhood_comparer <full, partial, compile, append, compact, merge, update, serve, index or query> <args according to chosen mode>\n\n"
 
 				<<"ARGUMENTS FOR EACH EXECUTION MODE:\n"
 				<<"  full --> default execution\n"
@@ -46,6 +110,19 @@ int main(int argc, char *argv[]) {
 			    <<"    -t --prot_stringency\n"
 				<<"    -r --neigh_stringency\n"
 			    <<"    -g --neigh_comparing\n"
+			    <<"    --gap_penalty\n"
+			    <<"    --colinear_reverse\n"
+			    <<"    --overlapping_windows\n"
+			    <<"    --seed_window\n"
+			    <<"    --seed_anchor\n"
+			    <<"    -j --threads\n"
+			    <<"    --memory_budget\n"
+			    <<"    --shard\n"
+			    <<"    --checkpoint\n"
+			    <<"    --resume\n"
+			    <<"    --incremental\n"
+			    <<"    --previous\n"
+			    <<"    --reference\n"
 			    <<"    -o --output\n"
 				<<"    -a --pairings_filename\n"
 
@@ -56,16 +133,158 @@ int main(int argc, char *argv[]) {
 			    <<"    -t --prot_stringency\n"
 				<<"    -r --neigh_stringency\n"
 			    <<"    -g --neigh_comparing\n"
+			    <<"    --gap_penalty\n"
+			    <<"    --colinear_reverse\n"
+			    <<"    --overlapping_windows\n"
+			    <<"    --seed_window\n"
+			    <<"    --seed_anchor\n"
+			    <<"    -j --threads\n"
+			    <<"    --memory_budget\n"
+			    <<"    --shard\n"
+			    <<"    --checkpoint\n"
+			    <<"    --resume\n"
+			    <<"    --incremental\n"
+			    <<"    --previous\n"
+			    <<"    --reference\n"
 			    <<"    -o --output\n"
-				<<"-a --pairings_filename\n";
+				<<"-a --pairings_filename\n"
+
+				<<"  compile --> Compiles the similarities between the proteins into a binary graph, usable as -s.\n"
+			    <<"    -e --execution_mode compile\n"
+			    <<"    -s --prot_sim_filename\n"
+			    <<"    -o --output\n"
+
+				<<"  append --> Appends the new or changed similarities between the proteins to a compiled graph, as a segment.\n"
+			    <<"    -e --execution_mode append\n"
+			    <<"    -s --prot_sim_filename\n"
+			    <<"    -o --output\n"
+
+				<<"  compact --> Folds the segments of a compiled graph back into a single graph.\n"
+			    <<"    -e --execution_mode compact\n"
+			    <<"    -o --output\n"
+
+				<<"  merge --> Merges the outputs of the shards of a comparison into the output of a single run.\n"
+			    <<"    -e --execution_mode merge\n"
+			    <<"    -g --neigh_comparing\n"
+			    <<"    --shard\n"
+			    <<"    -o --output\n"
+				<<"    -a --pairings_filename\n"
+
+				<<"  update --> Compares again only the neighborhoods with protein similarities that changed since previous results.\n"
+			    <<"    -e --execution_mode update\n"
+			    <<"    -n --neighborhoods_filename\n"
+			    <<"    -s --prot_sim_filename\n"
+			    <<"    --previous\n"
+			    <<"    -l --normalize_prot_sim\n"
+			    <<"    -t --prot_stringency\n"
+				<<"    -r --neigh_stringency\n"
+			    <<"    -g --neigh_comparing\n"
+			    <<"    --gap_penalty\n"
+			    <<"    --colinear_reverse\n"
+			    <<"    --seed_window\n"
+			    <<"    --seed_anchor\n"
+			    <<"    -j --threads\n"
+			    <<"    -o --output\n"
+				<<"    -a --pairings_filename\n"
+
+				<<"  serve --> Keeps the neighborhoods and the protein similarities in memory and answers requests to score them.\n"
+			    <<"    -e --execution_mode serve\n"
+			    <<"    -n --neighborhoods_filename\n"
+			    <<"    -s --prot_sim_filename\n"
+			    <<"    -l --normalize_prot_sim\n"
+			    <<"    -t --prot_stringency\n"
+				<<"    -r --neigh_stringency\n"
+			    <<"    -g --neigh_comparing\n"
+			    <<"    --gap_penalty\n"
+			    <<"    --colinear_reverse\n"
+			    <<"    --seed_window\n"
+			    <<"    --seed_anchor\n"
+			    <<"    -j --threads\n"
+			    <<"    --socket\n"
+
+				<<"  index --> Indexes the genomic neighborhoods by their proteins, for the query execution mode.\n"
+			    <<"    -e --execution_mode index\n"
+			    <<"    -n --neighborhoods_filename\n"
+			    <<"    -s --prot_sim_filename\n"
+			    <<"    -o --output\n"
+
+				<<"  query --> Finds the best partners of new genomic neighborhoods in an index.\n"
+			    <<"    -e --execution_mode query\n"
+			    <<"    -q --query\n"
+			    <<"    --index\n"
+			    <<"    -s --prot_sim_filename\n"
+			    <<"    -l --normalize_prot_sim\n"
+			    <<"    -t --prot_stringency\n"
+				<<"    -r --neigh_stringency\n"
+			    <<"    -g --neigh_comparing\n"
+			    <<"    --gap_penalty\n"
+			    <<"    --colinear_reverse\n"
+			    <<"    --seed_window\n"
+			    <<"    --seed_anchor\n"
+			    <<"    --top\n"
+			    <<"    -o --output\n";
 
 		return 0;
 	}
 
 	/*Actual program execution*/
 	std::string execution_mode = result["execution_mode"].as<std::string>();
-	std::string neighborhoods_filename = result["neighborhoods_filename"].as<std::string>();
+	if (execution_mode == "merge") {
+		if (mpi_rank() > 0) return 0;
+		int shards = result.count("shard") ? std::atoi(result["shard"].as<std::string>().c_str()) : 0;
+		if (shards < 1) {
+			std::cerr << "ERROR: merging requires the number of shards (--shard N)\n";
+			exit(1);
+		}
+		std::cout << "Merging shards...\n";
+		merge_shards(result["neigh_comparing"].as<std::string>(), result["output"].as<std::string>(),
+		             result["pairings_filename"].as<std::string>(), shards);
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
+	if (execution_mode == "compact") {
+		if (mpi_rank() > 0) return 0;
+		std::cout << "Compacting compiled graph...\n";
+		CompiledGraph::compact(result["output"].as<std::string>());
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
 	std::string prot_sim_filename = result["prot_sim_filename"].as<std::string>();
+
+	if (execution_mode == "compile") {
+		if (mpi_rank() > 0) return 0;
+		std::cout << "Compiling protein similarities...\n";
+		CompiledGraph::compile(prot_sim_filename, result["output"].as<std::string>());
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
+	if (execution_mode == "append") {
+		if (mpi_rank() > 0) return 0;
+		std::cout << "Appending protein similarities...\n";
+		unsigned long long similarities = CompiledGraph::append(prot_sim_filename, result["output"].as<std::string>());
+		std::cerr << "Similarities added or changed: " << similarities << "\n";
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
+	if (execution_mode == "index") {
+		if (mpi_rank() > 0) return 0;
+		std::cout << "Parsing genomic neighborhoods...\n";
+		NeighborhoodStore neighborhoods = parse_neighborhoods(result["neighborhoods_filename"].as<std::string>());
+		CompiledGraph graph;
+		graph.open(compiled_graph(prot_sim_filename));
+
+		std::cout << "\nIndexing genomic neighborhoods...\n";
+		NeighborhoodIndex::build(neighborhoods, graph, result["output"].as<std::string>());
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
+	//Not given in query mode
+	std::string neighborhoods_filename = result.count("neighborhoods_filename") ? result["neighborhoods_filename"].as<std::string>() : "";
 	double prot_stringency = result["prot_stringency"].as<double>();
 	double neigh_stringency = result["neigh_stringency"].as<double>();
 
@@ -73,19 +292,177 @@ int main(int argc, char *argv[]) {
 	std::string output = result["output"].as<std::string>() ;
 	std::string pairings_filename = result["pairings_filename"].as<std::string>();
 
+	clustering_options_t clustering_options;
+	clustering_options.gap_penalty = result["gap_penalty"].as<double>();
+	clustering_options.colinear_reverse = result.count("colinear_reverse");
+	clustering_options.overlapping_windows = result.count("overlapping_windows");
+	clustering_options.seed_window = result["seed_window"].as<int>();
+	clustering_options.seed_anchor = result.count("seed_anchor");
+	clustering_options.threads = result["threads"].as<int>();
+	clustering_options.memory_budget = (size_t)std::max(result["memory_budget"].as<int>(), 0) << 20;
+	clustering_options.shard = 0;
+	clustering_options.shards = 1;
+	clustering_options.checkpoint_interval = std::max(result["checkpoint"].as<int>(), 0);
+	clustering_options.resume = result.count("resume");
+	clustering_options.first_new = 0;
+	clustering_options.first_reference = 0;
+	if (clustering_options.gap_penalty < 0) {
+		std::cerr << "ERROR: --gap_penalty can't be negative\n";
+		exit(1);
+	}
+	bool incremental = result.count("incremental");
+	if (incremental && (!result.count("previous") || output == "-" || clustering_options.memory_budget > 0 ||
+	                    result.count("shard"))) {
+		std::cerr << "ERROR: --incremental requires --previous and the output filename of the previous results, and can't be"
+		          << " used with --memory_budget or --shard\n";
+		exit(1);
+	}
+	if (result.count("reference") && (incremental || clustering_options.overlapping_windows)) {
+		std::cerr << "ERROR: --reference can't be used with --incremental or --overlapping_windows\n";
+		exit(1);
+	}
+	if (mpi_ranks() > 1 && clustering_options.memory_budget > 0) {
+		std::cerr << "ERROR: the MPI ranks can't compare the neighborhoods under a memory budget\n";
+		exit(1);
+	}
+	if ((clustering_options.checkpoint_interval > 0 || clustering_options.resume) &&
+	    (clustering_options.memory_budget > 0 || mpi_ranks() > 1)) {
+		std::cerr << "ERROR: checkpoints can't be used with a memory budget or more than one MPI rank\n";
+		exit(1);
+	}
+	if (result.count("shard")) {
+		char rest;
+		if (sscanf(result["shard"].as<std::string>().c_str(), "%d/%d%c", &clustering_options.shard, &clustering_options.shards,
+		           &rest) != 2 || clustering_options.shard < 0 || clustering_options.shard >= clustering_options.shards) {
+			std::cerr << "ERROR: --shard must be i/N, with i from 0 to N - 1\n";
+			exit(1);
+		}
+		if (output == "-" || clustering_options.memory_budget > 0 || mpi_ranks() > 1) {
+			std::cerr << "ERROR: comparing a shard requires an output filename, no memory budget and a single MPI rank\n";
+			exit(1);
+		}
+		//Each shard writes its own outputs, merged by the merge mode
+		output = shard_filename(output, clustering_options.shard);
+		if (pairings_filename != "&")
+			pairings_filename = shard_filename(pairings_filename, clustering_options.shard);
+	}
+
+	if (execution_mode == "update") {
+		if (mpi_rank() > 0) return 0;
+		if (!result.count("previous") || output == "-" || incremental || clustering_options.overlapping_windows ||
+		    clustering_options.memory_budget > 0 || result.count("shard") || clustering_options.checkpoint_interval > 0 ||
+		    clustering_options.resume) {
+			std::cerr << "ERROR: updating requires --previous and the output filename of the previous results, and can't be"
+			          << " used with --incremental, --overlapping_windows, --memory_budget, --shard or checkpoints\n";
+			exit(1);
+		}
+		std::cout << "Parsing genomic neighborhoods...\n";
+		NeighborhoodStore neighborhoods = parse_neighborhoods(neighborhoods_filename);
+
+		CompiledGraph previous_graph, graph;
+		previous_graph.open(compiled_graph(result["previous"].as<std::string>()));
+		graph.open(compiled_graph(prot_sim_filename));
+
+		std::cout << "\nUpdating the clustering of genomic neighborhoods...\n";
+		genome_clustering_update(neighborhoods, previous_graph, graph, result.count("normalize_prot_sim"), neigh_comparing,
+		                         prot_stringency, neigh_stringency, output, pairings_filename, clustering_options);
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
+	if (execution_mode == "query") {
+		if (mpi_rank() > 0) return 0;
+		if (!result.count("query") || !result.count("index") || !CompiledGraph::is_compiled(prot_sim_filename) ||
+		    clustering_options.overlapping_windows) {
+			std::cerr << "ERROR: querying requires --query, --index and the compiled graph the index was built from, and"
+			          << " can't be used with --overlapping_windows\n";
+			exit(1);
+		}
+		CompiledGraph graph;
+		graph.open(prot_sim_filename);
+		NeighborhoodIndex index;
+		index.open(result["index"].as<std::string>(), graph);
+		NeighborhoodStore queries = parse_neighborhoods(result["query"].as<std::string>());
+
+		genome_clustering_query(queries, index, graph, result.count("normalize_prot_sim"), neigh_comparing, prot_stringency,
+		                        neigh_stringency, result["top"].as<int>(), output, clustering_options);
+		return 0;
+	}
+
+	if (execution_mode == "serve") {
+		if (!result.count("socket") || incremental || clustering_options.overlapping_windows ||
+		    clustering_options.memory_budget > 0 || result.count("shard") || clustering_options.checkpoint_interval > 0 ||
+		    clustering_options.resume || mpi_ranks() > 1) {
+			std::cerr << "ERROR: serving requires --socket, and can't be used with --incremental, --overlapping_windows,"
+			          << " --memory_budget, --shard, checkpoints or more than one MPI rank\n";
+			exit(1);
+		}
+		std::cout << "Parsing genomic neighborhoods...\n";
+		NeighborhoodStore neighborhoods = parse_neighborhoods(neighborhoods_filename);
+
+		std::cout << "\nServing genomic neighborhood comparisons...\n";
+		genome_clustering_serve(neighborhoods, prot_sim_filename, result.count("normalize_prot_sim"), neigh_comparing,
+		                        prot_stringency, neigh_stringency, result["socket"].as<std::string>(), clustering_options);
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
 	ProteinCollection prot_clusters;
 	int num_prot;
 
+	if (neighborhoods_filename == "-" && (execution_mode == "full" || execution_mode == "partial")) {
+		//The neighborhoods are read from stdin and each one is compared as it arrives
+		if (incremental || result.count("reference") || clustering_options.overlapping_windows ||
+		    clustering_options.memory_budget > 0 || result.count("shard") || clustering_options.checkpoint_interval > 0 ||
+		    clustering_options.resume || mpi_ranks() > 1) {
+			std::cerr << "ERROR: streaming the neighborhoods can't be used with --incremental, --reference,"
+			          << " --overlapping_windows, --memory_budget, --shard, checkpoints or more than one MPI rank\n";
+			exit(1);
+		}
+		if (execution_mode == "full") {
+			std::cout << "Applying homology detection method...\n";
+			homology_detection(result["formatted_prot_filename"].as<std::string>(),
+			                   result["protein_comparing"].as<std::string>(), prot_sim_filename);
+		}
+
+		std::cout << "\nClustering proteins...\n";
+		prot_clusters = protein_clustering(prot_sim_filename, 0);
+		if (execution_mode == "partial" && result.count("normalize_prot_sim"))
+			prot_clusters.normalize();
+
+		std::cout << "\nClustering the streamed genomic neighborhoods...\n";
+		genome_clustering_stream(std::cin, prot_clusters, neigh_comparing, prot_stringency, neigh_stringency, output,
+		                         pairings_filename, clustering_options);
+		std::cout << "\nDone!\n";
+		return 0;
+	}
+
 	if (execution_mode == "full") {
 		//default execution
 		std::string formatted_prot_filename = result["formatted_prot_filename"].as<std::string>();
 		std::string protein_comparing = result["protein_comparing"].as<std::string>();
 
 		std::cout << "Applying homology detection method...\n";
-		homology_detection(formatted_prot_filename, protein_comparing, prot_sim_filename);
+		//With MPI, the similarities are found once, by rank 0
+		if (mpi_rank() == 0)
+			homology_detection(formatted_prot_filename, protein_comparing, prot_sim_filename);
+#ifdef USE_MPI
+		MPI_Barrier(MPI_COMM_WORLD);
+#endif
 
 		std::cout << "Parsing genomic neighborhoods...\n";
-		std::vector<GenomicNeighborhood> neighborhoods = parse_neighborhoods(neighborhoods_filename);
+		NeighborhoodStore neighborhoods = parse_neighborhoods(neighborhoods_filename);
+		if (incremental)
+			clustering_options.first_new = previous_neighborhoods(neighborhoods, result["previous"].as<std::string>());
+		if (result.count("reference"))
+			clustering_options.first_reference = reference_neighborhoods(neighborhoods, result["reference"].as<std::string>());
+
+		if (clustering_options.memory_budget > 0) {
+			blocked_clustering(neighborhoods, prot_sim_filename, false, neigh_comparing, prot_stringency, neigh_stringency,
+			                   output, pairings_filename, clustering_options);
+			std::cout << "\nDone!";
+			return 0;
+		}
 
 		num_prot = total_protein_count(neighborhoods);
 
@@ -93,7 +470,8 @@ int main(int argc, char *argv[]) {
 		prot_clusters = protein_clustering(prot_sim_filename, num_prot);
 
 		std::cout << "\nClustering genomic neighborhoods...\n";
-		genome_clustering(neighborhoods, prot_clusters, neigh_comparing, prot_stringency, neigh_stringency, output, pairings_filename);
+		genome_clustering(neighborhoods, prot_clusters, neigh_comparing, prot_stringency, neigh_stringency, output, pairings_filename,
+		                  clustering_options);
 
 		std::cout << "\nDone!";
 	}
@@ -103,7 +481,18 @@ int main(int argc, char *argv[]) {
 		int normalize_prot_sim = result.count("normalize_prot_sim");
 
 		std::cout << "Parsing genomic neighborhoods...\n";
-		std::vector<GenomicNeighborhood> neighborhoods = parse_neighborhoods(neighborhoods_filename);
+		NeighborhoodStore neighborhoods = parse_neighborhoods(neighborhoods_filename);
+		if (incremental)
+			clustering_options.first_new = previous_neighborhoods(neighborhoods, result["previous"].as<std::string>());
+		if (result.count("reference"))
+			clustering_options.first_reference = reference_neighborhoods(neighborhoods, result["reference"].as<std::string>());
+
+		if (clustering_options.memory_budget > 0) {
+			blocked_clustering(neighborhoods, prot_sim_filename, normalize_prot_sim, neigh_comparing, prot_stringency,
+			                   neigh_stringency, output, pairings_filename, clustering_options);
+			std::cout << "\nDone!\n";
+			return 0;
+		}
 
 		num_prot = total_protein_count(neighborhoods);
 
@@ -114,9 +503,27 @@ int main(int argc, char *argv[]) {
 			prot_clusters.normalize();
 
 		std::cout << "\nClustering genomic neighborhoods...\n";
-		genome_clustering(neighborhoods, prot_clusters, neigh_comparing, prot_stringency, neigh_stringency, output, pairings_filename);
+		genome_clustering(neighborhoods, prot_clusters, neigh_comparing, prot_stringency, neigh_stringency, output, pairings_filename,
+		                  clustering_options);
 
 		std::cout << "\nDone!\n";
 
 	}
+	return 0;
+}
+
+#ifdef USE_MPI
+int main(int argc, char *argv[]) {
+	/*Every rank runs the program; the neighborhoods are compared by all of them (see genome_clustering_mpi)*/
+	MPI_Init(&argc, &argv);
+	if (mpi_rank() > 0) //only rank 0 reports the progress
+		std::cout.setstate(std::ios::badbit);
+	int status = run(argc, argv);
+	MPI_Finalize();
+	return status;
+}
+#else
+int main(int argc, char *argv[]) {
+	return run(argc, argv);
 }
+#endif
@@ -1,14 +1,12 @@
 #include "porthodomO2_scoring.h"
 
 /**
- *Receives two pairs of proteins, a ProteinCollection and a threshold value.
+ *Receives the similarities of two pairs of proteins and a threshold value.
  *The score returned is the average of the similarities between the pairs.
  */
-static int clustering_value(protein_info_t prot_g1_1, protein_info_t prot_g1_2, protein_info_t prot_g2_1,
-                            protein_info_t prot_g2_2, ProteinCollection &clusters, double stringency) {
+static int clustering_value(double similarity_1, double similarity_2, double stringency) {
 
-  double result = (clusters.get_similarity(prot_g1_1.pid, prot_g2_1.pid) +
-                   clusters.get_similarity(prot_g1_2.pid, prot_g2_2.pid))/2;
+  double result = (similarity_1 + similarity_2)/2;
   if (result >= stringency) //Should I check if both similarities are greater and then apply the mean? !!!
     return (int)(1000000*result);
   else
@@ -17,25 +15,18 @@ static int clustering_value(protein_info_t prot_g1_1, protein_info_t prot_g1_2,
 }
 
 /**
- *Receives two genomic neighborhoods, g1 and g2, and the ProteinCollection.
+ *Receives the similarity block of two genomic neighborhoods, g1 and g2.
  *Fills an integer matrix where matrix[i][j] is the similarity measure between the i-th pair of proteins of g1 and
- *the j-th pair of proteins of g2.
+ *the j-th pair of proteins of g2, derived from the two adjacent diagonal cells (i, j) and (i+1, j+1) of the block.
  */
-static std::vector<std::vector<int> > fill_assignment_matrix(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                                                     ProteinCollection &clusters, double stringency) {
-
-    int i = 0;
-    int j = 0;
-    std::vector<std::vector<int> > matrix(g1.protein_count() - 1, std::vector<int> (g2.protein_count()));
-
-    for(GenomicNeighborhood::iterator it = g1.begin(), it_last = --g1.end(); it != it_last; ++it) {
-        j = 0;
-        for(GenomicNeighborhood::iterator it2 = g2.begin(), it2_last = --g2.end(); it2 != it2_last; ++it2) {
-            matrix[i][j] = clustering_value(*it, *(std::next(it)), *it2, *(std::next(it2)), clusters, stringency);
-            j++;
-        }
-        i++;
-    }
+static hungarian_matrix_t fill_assignment_matrix(const SimilarityBlock &block, double stringency) {
+
+    hungarian_matrix_t matrix(block.rows() - 1, arena_vector<int> (block.cols() - 1));
+
+    for(int i = 0; i < block.rows() - 1; i++)
+        for(int j = 0; j < block.cols() - 1; j++)
+            matrix[i][j] = clustering_value(block.at(i, j), block.at(i + 1, j + 1), stringency);
+
     return matrix;
 }
 
@@ -43,18 +34,51 @@ static std::vector<std::vector<int> > fill_assignment_matrix(GenomicNeighborhood
  *Receives two genomic neighborhoods, a ProteinCollection and the protein stringency.
  *Returns the MWM porthodom  O2 protein assignments between the two neighborhoods
  */
-std::map<std::pair<int, int>, int> porthodomO2_assignments(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                                                           ProteinCollection &clusters, double prot_stringency) {
+assignments_t porthodomO2_assignments(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                                      ProteinCollection &clusters, double prot_stringency) {
     //DEBUG
     /*std::cout <<"Comparing (" << g1.get_accession() << ") and "
                 << "(" << g2.get_accession() << ", ):\n";*/
 
-    std::map<std::pair<int, int>, int> assignments;
-    std::vector<std::vector<int> > matrix = fill_assignment_matrix(g1, g2, clusters, prot_stringency);
+    SimilarityBlock block;
+    block.fill(g1, g2, clusters);
+    return porthodomO2_assignments(block, prot_stringency);
+}
+
+/**
+ *Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns the MWM porthodom  O2 protein assignments between the two neighborhoods
+ */
+assignments_t porthodomO2_assignments(const SimilarityBlock &block, double prot_stringency) {
+    bool below_min;
+    std::vector<int> potentials;
+    return porthodomO2_assignments(block, prot_stringency, 0, below_min, potentials);
+}
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the protein stringency and the minimum total weight
+ *the assignments must reach (0 for no minimum).
+ *Returns the MWM porthodom  O2 protein assignments between the two neighborhoods, or no assignments with below_min
+ *set if the solver proved early that the minimum can't be reached.
+ *The solver starts from the given column potentials (if any) and leaves its own in them.
+ */
+assignments_t porthodomO2_assignments(const SimilarityBlock &block, double prot_stringency,
+                                      double min_total, bool &below_min,
+                                      std::vector<int> &potentials) {
+
+    assignments_t assignments;
+    hungarian_matrix_t matrix = fill_assignment_matrix(block, prot_stringency);
     Hungarian my_hungarian (matrix, matrix.size(), matrix[0].size(), HUNGARIAN_MODE_MAXIMIZE_UTIL);
+    if (min_total > 0)
+        my_hungarian.set_cutoff((long long)(1000000*min_total) - 2); //margin for the rounding of the scores
+    my_hungarian.set_column_potentials(potentials);
 
     my_hungarian.solve();
-    assignments = my_hungarian.get_assignments();
+    below_min = my_hungarian.below_cutoff();
+    if (!below_min)
+        assignments = my_hungarian.get_assignments();
+    const arena_vector<int> &column_potentials = my_hungarian.column_potentials();
+    potentials.assign(column_potentials.begin(), column_potentials.end());
     return assignments;
 }
 
@@ -62,11 +86,26 @@ std::map<std::pair<int, int>, int> porthodomO2_assignments(GenomicNeighborhood &
  *Receives the porthodom assignments and a normalizing factor (length of the longest neighborhood).
  *Returns the porthodom MWM_O2 score (that takes order in consideration).
  */
-double porthodomO2_scoring(std::map<std::pair<int, int>, int> &assignments, int length) {
+double porthodomO2_scoring(assignments_t &assignments, int length) {
     double score = 0;
-    for (std::map<std::pair<int, int>,int>::iterator it = assignments.begin(); it != assignments.end(); ++it)
+    for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
         score += ((double)it->second)/1000000; //Division to undo the multiplication in clustering_value()
 
     //apply the scoring formula
     return score/length;
 }
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the protein stringency, the total weight of the
+ *porthodom assignments between them (or an upper bound on it) and the normalizing factor of the O2 score.
+ *Returns an upper bound on the porthodomO2 score.
+ *The (i, j) terms of the chosen O2 cells form a valid matching of the block, and so do the (i+1, j+1) terms, so each
+ *half of the O2 total is at most the porthodom total. A cell can only reach the stringency with one of its terms
+ *below it, which adds at most stringency/2 per cell, and the integer truncation adds at most 1/1000000 per cell.
+ */
+double porthodomO2_upper_bound(const SimilarityBlock &block, double prot_stringency, double porthodom_total, int length) {
+    int cells = std::min(block.rows(), block.cols()) - 1;
+    double total = porthodom_total + cells*(std::max(prot_stringency, 0.0)/2) + (cells + 1)*0.000001;
+
+    return total/length;
+}
@@ -8,17 +8,44 @@
 #include "Hungarian.h"
 #include "GenomicNeighborhood.h"
 #include "ProteinCollection.h"
+#include "SimilarityBlock.h"
 
 /**
  *Receives the porthodom assignments and a normalizing factor (length of the longest neighborhood).
  *Returns the porthodom O2 MWM score (that takes order in consideration).
  */
-double porthodomO2_scoring(std::map<std::pair<int, int>, int> &assignments, int length);
+double porthodomO2_scoring(assignments_t &assignments, int length);
 
 /**
  *Receives two genomic neighborhoods, a ProteinCollection and the protein stringency.
  *Returns the MWM porthodom  O2 protein assignments between the two neighborhoods
  */
-std::map<std::pair<int, int>, int> porthodomO2_assignments(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                                                           ProteinCollection &clusters, double prot_stringency);
+assignments_t porthodomO2_assignments(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                                      ProteinCollection &clusters, double prot_stringency);
+
+/**
+ *Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns the MWM porthodom  O2 protein assignments between the two neighborhoods
+ */
+assignments_t porthodomO2_assignments(const SimilarityBlock &block, double prot_stringency);
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the protein stringency and the minimum total weight
+ *the assignments must reach (0 for no minimum).
+ *Returns the MWM porthodom  O2 protein assignments between the two neighborhoods, or no assignments with below_min
+ *set if the solver proved early that the minimum can't be reached.
+ *potentials holds the solver potentials of a solve with the same pairs of g2 proteins to start from (or nothing)
+ *and receives the ones of this solve.
+ */
+assignments_t porthodomO2_assignments(const SimilarityBlock &block, double prot_stringency,
+                                      double min_total, bool &below_min,
+                                      std::vector<int> &potentials);
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the protein stringency, the total weight of the
+ *porthodom assignments between them (or an upper bound on it) and the normalizing factor of the O2 score.
+ *Returns an upper bound on the porthodomO2 score, so pairs that cannot reach the neighborhood stringency
+ *do not need to be solved.
+ */
+double porthodomO2_upper_bound(const SimilarityBlock &block, double prot_stringency, double porthodom_total, int length);
 #endif
@@ -0,0 +1,108 @@
+#include "porthodomOk_scoring.h"
+
+/**
+ *Receives the sum of the similarities of two runs of k proteins, the order k and a threshold value.
+ *The score returned is the average of the similarities between the proteins of the runs.
+ */
+static int clustering_value(double similarity_sum, int order, double stringency) {
+
+  double result = similarity_sum/order;
+  if (result >= stringency)
+    return (int)(1000000*result);
+  else
+    return 0;
+
+}
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, g1 and g2, and the order k.
+ *Fills an integer matrix where matrix[i][j] is the similarity measure between the run of k proteins of g1 starting
+ *at i and the run of k proteins of g2 starting at j.
+ *The runs are sums along the diagonals of the block, taken from prefix sums along them, so the matrix is filled
+ *in O(rows*cols) whatever the order.
+ */
+static hungarian_matrix_t fill_assignment_matrix(const SimilarityBlock &block, int order, double stringency) {
+
+    int rows = block.rows();
+    int cols = block.cols();
+
+    //prefix[i+1][j+1] = block(i, j) + block(i-1, j-1) + ... up to the border of the block
+    arena_vector<arena_vector<double> > prefix(rows + 1, arena_vector<double>(cols + 1, 0));
+    for(int i = 0; i < rows; i++)
+        for(int j = 0; j < cols; j++)
+            prefix[i + 1][j + 1] = prefix[i][j] + block.at(i, j);
+
+    hungarian_matrix_t matrix(rows - order + 1, arena_vector<int>(cols - order + 1));
+    for(int i = 0; i <= rows - order; i++)
+        for(int j = 0; j <= cols - order; j++)
+            matrix[i][j] = clustering_value(prefix[i + order][j + order] - prefix[i][j], order, stringency);
+
+    return matrix;
+}
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the order k of the method and the protein stringency.
+ *Returns the MWM porthodom Ok assignments between the two neighborhoods.
+ */
+assignments_t porthodomOk_assignments(const SimilarityBlock &block, int order, double prot_stringency) {
+    bool below_min;
+    std::vector<int> potentials;
+    return porthodomOk_assignments(block, order, prot_stringency, 0, below_min, potentials);
+}
+
+/**
+ *Same as above, receiving also the minimum total weight the assignments must reach (0 for no minimum).
+ *Returns no assignments, with below_min set, if the solver proved early that the minimum can't be reached.
+ *The solver starts from the given column potentials (if any) and leaves its own in them.
+ */
+assignments_t porthodomOk_assignments(const SimilarityBlock &block, int order, double prot_stringency,
+                                      double min_total, bool &below_min,
+                                      std::vector<int> &potentials) {
+
+    assignments_t assignments;
+    hungarian_matrix_t matrix = fill_assignment_matrix(block, order, prot_stringency);
+    Hungarian my_hungarian (matrix, matrix.size(), matrix[0].size(), HUNGARIAN_MODE_MAXIMIZE_UTIL);
+    if (min_total > 0)
+        my_hungarian.set_cutoff((long long)(1000000*min_total) - 2); //margin for the rounding of the scores
+    my_hungarian.set_column_potentials(potentials);
+
+    my_hungarian.solve();
+    below_min = my_hungarian.below_cutoff();
+    if (!below_min)
+        assignments = my_hungarian.get_assignments();
+    const arena_vector<int> &column_potentials = my_hungarian.column_potentials();
+    potentials.assign(column_potentials.begin(), column_potentials.end());
+    return assignments;
+}
+
+/**
+ *Receives the porthodom Ok assignments and a normalizing factor (number of runs of k proteins in the
+ *longest neighborhood).
+ *Returns the porthodom Ok MWM score (that takes order in consideration).
+ */
+double porthodomOk_scoring(assignments_t &assignments, int length) {
+    double score = 0;
+    for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
+        score += ((double)it->second)/1000000; //Division to undo the multiplication in clustering_value()
+
+    //apply the scoring formula
+    return score/length;
+}
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the order k of the method, the protein stringency,
+ *the total weight of the porthodom assignments between them (or an upper bound on it) and the normalizing factor
+ *of the Ok score.
+ *Returns an upper bound on the porthodom Ok score.
+ *Each of the k shifted terms of the chosen cells forms a valid matching of the block, so their average is at most
+ *the porthodom total. Up to k-1 terms of a cell can be below the stringency, which adds at most
+ *stringency*(k-1)/k per cell, and the integer truncation adds at most 1/1000000 per matched protein.
+ */
+double porthodomOk_upper_bound(const SimilarityBlock &block, int order, double prot_stringency,
+                               double porthodom_total, int length) {
+    int cells = std::min(block.rows(), block.cols()) - order + 1;
+    double total = porthodom_total + cells*(std::max(prot_stringency, 0.0)*(order - 1)/order) +
+                   (cells + order - 1)*0.000001;
+
+    return total/length;
+}
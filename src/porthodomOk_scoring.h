@@ -0,0 +1,42 @@
+#ifndef __PORTHODOMOK_SCORING_H__
+#define __PORTHODOMOK_SCORING_H__
+
+#include <map>
+#include <string>
+#include <algorithm>
+#include "Hungarian.h"
+#include "SimilarityBlock.h"
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the order k of the method (length of the runs of
+ *adjacent proteins compared) and the protein stringency.
+ *Returns the MWM porthodom Ok assignments between the two neighborhoods, where the assignment (i, j) pairs the
+ *proteins i..i+k-1 of g1 with the proteins j..j+k-1 of g2.
+ */
+assignments_t porthodomOk_assignments(const SimilarityBlock &block, int order, double prot_stringency);
+
+/**
+ *Same as above, receiving also the minimum total weight the assignments must reach (0 for no minimum).
+ *Returns no assignments, with below_min set, if the solver proved early that the minimum can't be reached.
+ *potentials is used as in porthodomO2_assignments.
+ */
+assignments_t porthodomOk_assignments(const SimilarityBlock &block, int order, double prot_stringency,
+                                      double min_total, bool &below_min,
+                                      std::vector<int> &potentials);
+
+/**
+ *Receives the porthodom Ok assignments and a normalizing factor (number of runs of k proteins in the
+ *longest neighborhood).
+ *Returns the porthodom Ok MWM score (that takes order in consideration).
+ */
+double porthodomOk_scoring(assignments_t &assignments, int length);
+
+/**
+ *Receives the similarity block of two genomic neighborhoods, the order k of the method, the protein stringency,
+ *the total weight of the porthodom assignments between them (or an upper bound on it) and the normalizing factor
+ *of the Ok score.
+ *Returns an upper bound on the porthodom Ok score.
+ */
+double porthodomOk_upper_bound(const SimilarityBlock &block, int order, double prot_stringency,
+                               double porthodom_total, int length);
+#endif
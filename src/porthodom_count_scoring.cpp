@@ -0,0 +1,46 @@
+#include "porthodom_count_scoring.h"
+
+/**
+ *Receives the similarity between two proteins and a threshold value.
+ *Returns an integer with 1000000x their similarity (the same scale used by porthodom) if they reach the threshold
+ *and 0 otherwise.
+ */
+static int clustering_value(double similarity, double stringency) {
+  if (similarity >= stringency)
+    return (int)(1000000*similarity);
+  else
+    return 0;
+}
+
+/*Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns a maximum set of one-to-one protein assignments between the two neighborhoods, treating every pair of
+ *proteins that reaches the stringency as an unweighted edge. The assignments keep the similarity of the pairs, so
+ *they are written to the pairings file like the porthodom ones.
+ */
+assignments_t porthodom_count_assignments(const SimilarityBlock &block, double prot_stringency) {
+
+    assignments_t assignments;
+    HopcroftKarp my_matching (block.rows(), block.cols());
+
+    //Only the nonzero cells of the block become edges
+    for(int i = 0; i < block.rows(); i++)
+        for(int j = 0; j < block.cols(); j++)
+            if (clustering_value(block.at(i, j), prot_stringency) > 0)
+                my_matching.add_edge(i, j);
+
+    my_matching.solve();
+    const arena_vector<int> &matching = my_matching.get_matching();
+    for(int i = 0; i < block.rows(); i++)
+        if (matching[i] >= 0)
+            assignments[std::make_pair(i, matching[i])] = clustering_value(block.at(i, matching[i]), prot_stringency);
+
+    return assignments;
+}
+
+/*Receives the porthodom count assignments and a normalizing factor (length of the longest neighborhood).
+ *Returns the porthodom count score.
+ */
+double porthodom_count_scoring(assignments_t &assignments, int length) {
+    //apply the scoring formula
+    return ((double)assignments.size())/length;
+}
@@ -0,0 +1,19 @@
+#ifndef __PORTHODOM_COUNT_SCORING_H__
+#define __PORTHODOM_COUNT_SCORING_H__
+
+#include <map>
+#include "HopcroftKarp.h"
+#include "SimilarityBlock.h"
+
+/*Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns a maximum set of one-to-one protein assignments between the two neighborhoods, treating every pair of
+ *proteins that reaches the stringency as an unweighted edge
+ */
+assignments_t porthodom_count_assignments(const SimilarityBlock &block, double prot_stringency);
+
+/*Receives the porthodom count assignments and a normalizing factor (length of the longest neighborhood).
+ *Returns the porthodom count score.
+ */
+double porthodom_count_scoring(assignments_t &assignments, int length);
+
+#endif
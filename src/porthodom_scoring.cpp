@@ -1,16 +1,11 @@
 #include "porthodom_scoring.h"
 
 /**
- *Receives two proteins, a ProteinCollection and a threshold value.
- *If the proteins are connected in the ProteinCollection, return an integer with 100x their similarity (because
- *the Hungarian class only works with integers).
+ *Receives the similarity between two proteins and a threshold value.
+ *Returns an integer with 1000000x their similarity (because the Hungarian class only works with integers).
  *If the proteins aren't connected or if their similarity is smaller than the threshold value, return 0.
  */
-static int clustering_value(protein_info_t my_prot, protein_info_t my_prot2, ProteinCollection &clusters,
-                            double stringency) {
-  //DEBUG
-  //std::cout << "clustering value between " << my_prot.pid << " and " << my_prot2.pid << " " << similarity << "\n";
-  double similarity = clusters.get_similarity(my_prot.pid, my_prot2.pid);
+static int clustering_value(double similarity, double stringency) {
   if (similarity >= stringency)
     return (int)(1000000*similarity);
   else
@@ -19,62 +14,248 @@ static int clustering_value(protein_info_t my_prot, protein_info_t my_prot2, Pro
 }
 
 /**
- *Receives two genomic neighborhoods, g1 and g2, and the ProteinCollection.
+ *Receives the similarity block of two genomic neighborhoods, g1 and g2.
  *Fills an integer matrix where matrix[i][j] is the similarity measure between the i-th protein of g1 and
- *the j-th protein of g2 are in the same cluster (connected in the ProteinCollection) and 0 otherwise.
+ *the j-th protein of g2 if it reaches the stringency and 0 otherwise.
  */
-static std::vector<std::vector<int> > fill_assignment_matrix(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                                                     ProteinCollection &clusters, double stringency) {
-
-    int i = 0;
-    int j = 0;
-    std::vector<std::vector<int> > matrix(g1.protein_count(), std::vector<int>(g2.protein_count()));
-
-    for(GenomicNeighborhood::iterator it = g1.begin(); it != g1.end(); ++it) {
-        j = 0;
-        for(GenomicNeighborhood::iterator it2 = g2.begin(); it2 != g2.end(); ++it2) {
-
-            //DEBUG
-            /*std::cout <<"matrix: " << i << " " << j << " " << it->pid << " " << it2->pid << "\n";*/
-            matrix[i][j] = clustering_value(*it, *it2, clusters, stringency);
-            //DEBUG
-            //std::cout <<"matrix: " << i << " " << j << " " << it->pid << " " << it2->pid << " score = " << matrix[i][j]<<"\n";
-            j++;
-        }
-        i++;
-    }
+static hungarian_matrix_t fill_assignment_matrix(const SimilarityBlock &block, double stringency) {
+
+    hungarian_matrix_t matrix(block.rows(), arena_vector<int>(block.cols()));
+
+    for(int i = 0; i < block.rows(); i++)
+        for(int j = 0; j < block.cols(); j++)
+            matrix[i][j] = clustering_value(block.at(i, j), stringency);
+
     return matrix;
 }
 
 /*Receives two genomic neighborhoods and a ProteinCollection.
  *Returns the MWM porthodom protein assignments between the two neighborhoods
  */
-std::map<std::pair<int, int>, int> porthodom_assignments(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
+assignments_t porthodom_assignments(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
                              ProteinCollection &clusters, double prot_stringency) {
 
     //DEBUG
     /*std::cout <<"Comparing (" << g1.get_accession() << ") and "
                 << "(" << g2.get_accession() << ", ):\n";*/
 
-    std::map<std::pair<int, int>, int> assignments;
-    std::vector<std::vector<int> > matrix = fill_assignment_matrix(g1, g2, clusters, prot_stringency);
+    SimilarityBlock block;
+    block.fill(g1, g2, clusters);
+    return porthodom_assignments(block, prot_stringency);
+}
+
+/*Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns the MWM porthodom protein assignments between the two neighborhoods
+ */
+assignments_t porthodom_assignments(const SimilarityBlock &block, double prot_stringency) {
+    bool below_min;
+    std::vector<int> potentials;
+    return porthodom_assignments(block, prot_stringency, 0, below_min, potentials);
+}
+
+/*Receives the similarity block of two genomic neighborhoods, the protein stringency and the minimum total weight
+ *the assignments must reach (0 for no minimum).
+ *Returns the MWM porthodom protein assignments between the two neighborhoods, or no assignments with below_min set
+ *if the solver proved early that the minimum can't be reached.
+ *The solver starts from the given column potentials (if any) and leaves its own in them.
+ */
+assignments_t porthodom_assignments(const SimilarityBlock &block, double prot_stringency,
+                                    double min_total, bool &below_min,
+                                    std::vector<int> &potentials) {
+
+    assignments_t assignments;
+    hungarian_matrix_t matrix = fill_assignment_matrix(block, prot_stringency);
     Hungarian my_hungarian (matrix, matrix.size(), matrix[0].size(), HUNGARIAN_MODE_MAXIMIZE_UTIL);
+    if (min_total > 0)
+        my_hungarian.set_cutoff((long long)(1000000*min_total) - 2); //margin for the rounding of the scores
+    my_hungarian.set_column_potentials(potentials);
 
     my_hungarian.solve();
-    assignments = my_hungarian.get_assignments();
+    below_min = my_hungarian.below_cutoff();
+    if (!below_min)
+        assignments = my_hungarian.get_assignments();
+    const arena_vector<int> &column_potentials = my_hungarian.column_potentials();
+    potentials.assign(column_potentials.begin(), column_potentials.end());
+    return assignments;
+}
+
+/*Receives the similarity block of two genomic neighborhoods, the positions of their seeds, the protein stringency
+ *and the minimum total weight the assignments must reach (0 for no minimum).
+ *Returns the porthodom protein assignments anchored on the seeds: the two seeds are paired and the flanks before
+ *and after them are solved separately, each on its own sub-block, or no assignments with below_min set if a solver
+ *proved early that the minimum can't be reached. Each flank is solved with the cutoff left by the seeds and the
+ *other flank (its upper bound before it is solved, its total after). As in porthodom_assignments, the proteins left
+ *unpaired are paired with padding (an index past the end of the other neighborhood).
+ */
+assignments_t porthodom_anchored_assignments(const SimilarityBlock &block, int seed1, int seed2,
+                                             double prot_stringency, double min_total, bool &below_min) {
+
+    assignments_t assignments;
+    assignments_t flank_assignments;
+    SimilarityBlock flanks[2];
+    std::vector<int> potentials;
+    int first_row[2] = {0, seed1 + 1};
+    int first_col[2] = {0, seed2 + 1};
+    int rows[2] = {seed1, block.rows() - seed1 - 1};
+    int cols[2] = {seed2, block.cols() - seed2 - 1};
+    below_min = false;
+
+    int seed_value = clustering_value(block.at(seed1, seed2), prot_stringency);
+    assignments[std::make_pair(seed1, seed2)] = seed_value;
+
+    //What the flanks must reach together, and the bound of the second one until it is solved
+    double remaining = min_total - ((double)seed_value)/1000000;
+    double later_bound = 0;
+    for (int side = 0; side < 2; side++)
+        if (rows[side] > 0 && cols[side] > 0)
+            flanks[side].view(block, first_row[side], first_col[side], rows[side], cols[side]);
+    if (rows[1] > 0 && cols[1] > 0)
+        later_bound = porthodom_upper_bound(flanks[1], prot_stringency);
+
+    std::vector<bool> row_paired(block.rows(), false), col_paired(block.cols(), false);
+    row_paired[seed1] = col_paired[seed2] = true;
+    for (int side = 0; side < 2; side++) {
+        if (rows[side] == 0 || cols[side] == 0) continue;
+
+        double flank_min = side == 0 ? remaining - later_bound : remaining;
+        potentials.clear();
+        flank_assignments = porthodom_assignments(flanks[side], prot_stringency, std::max(flank_min, 0.0), below_min,
+                                                  potentials);
+        if (below_min)
+            return assignments_t();
+        remaining -= porthodom_total(flank_assignments);
+
+        for (assignments_t::iterator it = flank_assignments.begin(); it != flank_assignments.end(); ++it)
+            if (it->first.first < rows[side] && it->first.second < cols[side]) { //padding is added below
+                int row = it->first.first + first_row[side], col = it->first.second + first_col[side];
+                assignments[std::make_pair(row, col)] = it->second;
+                row_paired[row] = col_paired[col] = true;
+            }
+    }
+
+    for (int i = 0; i < block.rows(); i++)
+        if (!row_paired[i])
+            assignments[std::make_pair(i, block.cols() + i)] = 0;
+    for (int j = 0; j < block.cols(); j++)
+        if (!col_paired[j])
+            assignments[std::make_pair(block.rows() + j, j)] = 0;
     return assignments;
 }
 
+/*Positions where each ProteinCollection index appears in a neighborhood*/
+typedef std::unordered_map<long, arena_vector<int>, std::hash<long>, std::equal_to<long>,
+                           ArenaAllocator<std::pair<const long, arena_vector<int> > > > positions_t;
+
+/*Receives a genomic neighborhood.
+ *Fills the index of each of its proteins in the ProteinCollection (-1 if absent) and the positions where each
+ *index appears in the neighborhood.
+ */
+static void index_proteins(const GenomicNeighborhood &g, arena_vector<long> &indexes, positions_t &positions) {
+    const long *g_indexes = g.indexes();
+    for(int i = 0; i < g.protein_count(); i++) {
+        if (g_indexes[i] >= 0)
+            positions[g_indexes[i]].push_back(i);
+        indexes.push_back(g_indexes[i]);
+    }
+}
+
+/*Receives two genomic neighborhoods, a ProteinCollection, the protein stringency and the minimum total weight the
+ *assignments must reach (0 for no minimum).
+ *Builds the edges between the proteins straight from the ProteinCollection (no dense matrix) and, if the pair is
+ *sparse enough, fills the assignments with the MWM porthodom assignments from the sparse solver (the unpaired
+ *proteins padded as in porthodom_anchored_assignments) and returns true. If the minimum can't be reached, leaves no
+ *assignments and sets below_min.
+ *Returns false, without solving, if the pair is too dense for it.
+ */
+bool porthodom_sparse_assignments(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, ProteinCollection &clusters,
+                                  double prot_stringency, double min_total, bool &below_min, assignments_t &assignments) {
+    arena_vector<long> indexes1, indexes2;
+    positions_t positions1, positions2;
+    index_proteins(g1, indexes1, positions1);
+    index_proteins(g2, indexes2, positions2);
+
+    SparseMatching my_matching (g1.protein_count(), g2.protein_count());
+
+    //Each connection is stored at its larger index: those with the g1 protein on the larger side are found from g1...
+    for(unsigned int i = 0; i < indexes1.size(); i++) {
+        if (indexes1[i] < 0) continue;
+        const std::unordered_map<int, double> &neighbors = clusters.lower_neighbors(indexes1[i]);
+        for(std::unordered_map<int, double>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
+            int value = clustering_value(it->second, prot_stringency);
+            positions_t::iterator found = positions2.find(it->first);
+            if (value <= 0 || found == positions2.end()) continue;
+            for(unsigned int k = 0; k < found->second.size(); k++)
+                my_matching.add_edge(i, found->second[k], value);
+        }
+    }
+    //...and the others from g2
+    for(unsigned int j = 0; j < indexes2.size(); j++) {
+        if (indexes2[j] < 0) continue;
+        const std::unordered_map<int, double> &neighbors = clusters.lower_neighbors(indexes2[j]);
+        for(std::unordered_map<int, double>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
+            int value = clustering_value(it->second, prot_stringency);
+            positions_t::iterator found = positions1.find(it->first);
+            if (value <= 0 || it->first == indexes2[j] || found == positions1.end()) continue;
+            for(unsigned int k = 0; k < found->second.size(); k++)
+                my_matching.add_edge(found->second[k], j, value);
+        }
+    }
+
+    int length = std::max(g1.protein_count(), g2.protein_count());
+    double density = ((double)my_matching.edge_count())/((double)g1.protein_count()*g2.protein_count());
+    if (density > SPARSE_MAX_DENSITY && length < SPARSE_ALWAYS_GENES)
+        return false;
+
+    //Same cutoff as porthodom_assignments: the cheap bound before solving, the total after it
+    long long cutoff = min_total > 0 ? (long long)(1000000*min_total) - 2 : 0; //margin for the rounding of the scores
+    below_min = my_matching.upper_bound() < cutoff || my_matching.solve() < cutoff;
+    assignments.clear();
+    if (!below_min)
+        assignments = my_matching.get_assignments();
+    return true;
+}
+
+/*Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns an upper bound on the total weight of the porthodom assignments (without solving them): the smaller of
+ *the sums of the row maxima and of the column maxima.
+ */
+double porthodom_upper_bound(const SimilarityBlock &block, double prot_stringency) {
+    arena_vector<int> col_max(block.cols(), 0);
+    double row_total = 0;
+    double col_total = 0;
+
+    for(int i = 0; i < block.rows(); i++) {
+        int row_max = 0;
+        for(int j = 0; j < block.cols(); j++) {
+            int value = clustering_value(block.at(i, j), prot_stringency);
+            row_max = std::max(row_max, value);
+            col_max[j] = std::max(col_max[j], value);
+        }
+        row_total += ((double)row_max)/1000000;
+    }
+    for(int j = 0; j < block.cols(); j++)
+        col_total += ((double)col_max[j])/1000000;
+
+    return std::min(row_total, col_total);
+}
+
 /*Receives the porthodom assignments and a normalizing factor (length of the longest neighborhood).
  *Returns the porthodom MWM score.
  */
 
-double porthodom_scoring(std::map<std::pair<int, int>, int> &assignments, int length) {
+double porthodom_scoring(assignments_t &assignments, int length) {
+    //apply the scoring formula
+    return porthodom_total(assignments)/length;
+
+}
+
+/*Receives the porthodom assignments.
+ *Returns their total weight (the porthodom score before normalization).
+ */
+double porthodom_total(assignments_t &assignments) {
     double score = 0;
-    for (std::map<std::pair<int, int>,int>::iterator it = assignments.begin(); it != assignments.end(); ++it)
+    for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
         score += ((double)it->second)/1000000; //Division to undo the multiplication in clustering_value()
 
-    //apply the scoring formula
-    return score/length;
-
+    return score;
 }
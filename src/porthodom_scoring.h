@@ -4,20 +4,75 @@
 #include <map>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
 #include "Hungarian.h"
 #include "GenomicNeighborhood.h"
 #include "ProteinCollection.h"
+#include "SimilarityBlock.h"
+#include "SparseMatching.h"
+
+#define SPARSE_MIN_GENES 100    //pairs whose longest neighborhood is shorter always use the dense Hungarian
+#define SPARSE_MAX_DENSITY 0.1  //denser pairs also use it...
+#define SPARSE_ALWAYS_GENES 400 //...unless their longest neighborhood has at least this many genes
 
 
 /*Receives two genomic neighborhoods a ProteinCollection and the protein stringency.
  *Returns the MWM porthodom protein assignments between the two neighborhoods
  */
-std::map<std::pair<int, int>, int> porthodom_assignments(GenomicNeighborhood &g1, GenomicNeighborhood &g2,
-                                                         ProteinCollection &clusters, double prot_stringency);
+assignments_t porthodom_assignments(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2,
+                                    ProteinCollection &clusters, double prot_stringency);
+
+/*Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns the MWM porthodom protein assignments between the two neighborhoods
+ */
+assignments_t porthodom_assignments(const SimilarityBlock &block, double prot_stringency);
+
+/*Receives the similarity block of two genomic neighborhoods, the protein stringency and the minimum total weight
+ *the assignments must reach (0 for no minimum).
+ *Returns the MWM porthodom protein assignments between the two neighborhoods, or no assignments with below_min set
+ *if the solver proved early that the minimum can't be reached.
+ *potentials warm starts the solver (the potentials of a solve sharing the columns, e.g. an adjacent window of g1,
+ *or empty) and receives the potentials of this solve.
+ */
+assignments_t porthodom_assignments(const SimilarityBlock &block, double prot_stringency,
+                                    double min_total, bool &below_min,
+                                    std::vector<int> &potentials);
+
+/*Receives the similarity block of two genomic neighborhoods, the positions of their seeds, the protein stringency
+ *and the minimum total weight the assignments must reach (0 for no minimum).
+ *Returns the porthodom protein assignments anchored on the seeds: the two seeds are paired and the proteins on
+ *each side of a seed are matched (MWM) only to the proteins on the same side of the other seed. Returns no
+ *assignments with below_min set if the solvers proved early that the minimum can't be reached.
+ *Being constrained, their total is not an upper bound of the porthodom (MWM) total.
+ */
+assignments_t porthodom_anchored_assignments(const SimilarityBlock &block, int seed1, int seed2,
+                                             double prot_stringency, double min_total, bool &below_min);
+
+/*Receives two genomic neighborhoods, a ProteinCollection, the protein stringency and the minimum total weight the
+ *assignments must reach (0 for no minimum).
+ *Builds the edges between the proteins straight from the ProteinCollection (no dense matrix) and, if the pair is
+ *sparse enough, fills the assignments with the MWM porthodom assignments from the sparse solver (the unpaired
+ *proteins padded as in porthodom_anchored_assignments) and returns true. If the minimum can't be reached, leaves no
+ *assignments and sets below_min.
+ *Returns false, without solving, if the pair is too dense for it.
+ */
+bool porthodom_sparse_assignments(const GenomicNeighborhood &g1, const GenomicNeighborhood &g2, ProteinCollection &clusters,
+                                  double prot_stringency, double min_total, bool &below_min, assignments_t &assignments);
+
+/*Receives the similarity block of two genomic neighborhoods and the protein stringency.
+ *Returns an upper bound on the total weight of the porthodom assignments (without solving them): the smaller of
+ *the sums of the row maxima and of the column maxima.
+ */
+double porthodom_upper_bound(const SimilarityBlock &block, double prot_stringency);
 
 /*Receives the porthodom assignments and a normalizing factor (length of the longest neighborhood).
  *Returns the porthodom MWM score.
  */
-double porthodom_scoring(std::map<std::pair<int, int>, int> &assignments, int length);
+double porthodom_scoring(assignments_t &assignments, int length);
+
+/*Receives the porthodom assignments.
+ *Returns their total weight (the porthodom score before normalization).
+ */
+double porthodom_total(assignments_t &assignments);
 
 #endif
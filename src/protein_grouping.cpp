@@ -22,6 +22,12 @@ void homology_detection(const std::string &format_file, const std::string &metho
 */
 ProteinCollection protein_clustering(const std::string &prot_sim_filename, unsigned int num_prot) {
 
+    if (CompiledGraph::is_compiled(prot_sim_filename)) {
+        CompiledGraph graph;
+        graph.open(prot_sim_filename);
+        return protein_clustering(graph);
+    }
+
     ProteinCollection my_proteins (num_prot);
     std::ifstream file;
     std::string prot1;
@@ -47,3 +53,23 @@ ProteinCollection protein_clustering(const std::string &prot_sim_filename, unsig
     file.close();
     return my_proteins;
 }
+
+/**
+* Receives a compiled similarity graph and stores all its similarities in a ProteinCollection.
+* The proteins get the same indexes as when reading the similarities file it was compiled from.
+*/
+ProteinCollection protein_clustering(const CompiledGraph &graph) {
+
+    ProteinCollection my_proteins (graph.protein_count());
+
+    for (long id = 0; id < graph.protein_count(); id++)
+        my_proteins.add_protein(graph.name(id));
+
+    for (long id = 0; id < graph.protein_count(); id++) {
+        const unsigned int *neighbors = graph.neighbors_of(id);
+        const double *weights = graph.weights_of(id);
+        for (long k = 0; k < graph.degree(id) && neighbors[k] <= id; k++)
+            my_proteins.connect_proteins(id, neighbors[k], weights[k]);
+    }
+    return my_proteins;
+}
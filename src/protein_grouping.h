@@ -6,6 +6,7 @@
 #include <fstream>
 #include <vector>
 #include "ProteinCollection.h"
+#include "CompiledGraph.h"
 
 /*Receives the user's preferred protein homology/orthology detection method and runs it on a file
  *already formatted to be its input.
@@ -13,9 +14,12 @@
 void homology_detection(const std::string &format_file, const std::string &method, const std::string &prot_sim_filename);
 
 /*Receives the similarities file and stores them in a ProteinCollection.
- *The similarities file must be in the format "prot1 prot2 sim" in every line
+ *The similarities file must be in the format "prot1 prot2 sim" in every line, or a compiled graph (see CompiledGraph)
  *num_prot must be the number of proteins and stringency is the minimum similarity
  *for two proteins to be considered part of the same cluster*/
 ProteinCollection protein_clustering(const std::string &prot_sim_filename, unsigned int num_prot);
 
+/*Receives a compiled similarity graph and stores all its similarities in a ProteinCollection*/
+ProteinCollection protein_clustering(const CompiledGraph &graph);
+
 #endif
@@ -0,0 +1,40 @@
+#include "../src/Hungarian.h"
+
+int main() {
+  /* the first column of row 0 is not its row minimum after the maximize transformation:
+     the initial matching used to pick it anyway and the optimum (20) was missed */
+  int r[2*3] = {0, 10, 10, 10, 10, 10};
+  hungarian_matrix_t m(2, arena_vector<int>(3));
+  int k = 0;
+
+  for (unsigned int i = 0; i < m.size(); i++)
+  	for (unsigned int j = 0; j < m[i].size(); j++)
+  		m[i][j] = r[k++];
+
+  Hungarian hungarian(m, 2, 3, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+  hungarian.solve();
+
+  assignments_t foo = hungarian.get_assignments();
+  int total = 0;
+  for (assignments_t::iterator it = foo.begin(); it != foo.end(); ++it)
+  	total += it->second;
+
+  fprintf(stderr, "total utility: %d (expected 20)\n", total);
+
+  /* a cutoff just below the optimum must not stop the solve; one just above it must */
+  Hungarian below(m, 2, 3, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+  below.set_cutoff(19);
+  below.solve();
+  assignments_t bar = below.get_assignments();
+  int below_total = 0;
+  for (assignments_t::iterator it = bar.begin(); it != bar.end(); ++it)
+  	below_total += it->second;
+  fprintf(stderr, "cutoff 19: below cutoff %d, total utility: %d (expected 0, 20)\n", below.below_cutoff(), below_total);
+
+  Hungarian above(m, 2, 3, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+  above.set_cutoff(21);
+  above.solve();
+  fprintf(stderr, "cutoff 21: below cutoff %d (expected 1)\n", above.below_cutoff());
+
+  return total == 20 && !below.below_cutoff() && below_total == 20 && above.below_cutoff() ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#include "../src/GenomicNeighborhood.h"
+
+int main() {
+	NeighborhoodStore my_store;
+	my_store.add_neighborhood("AABW01000001.1");
+	my_store.add_protein("EAA26069.1", "803087..804568");
+	my_store.add_protein("EAA26070.1", "804722..806695");
+	my_store.add_protein("EAA26071.1", "806695..807009");
+	my_store.add_protein("EAA26072.1", "807002..807619");
+	my_store.add_seed();
+	my_store.add_protein("EAA26073.1", "807652..807909");
+	my_store.add_protein("EAA26074.1", "807913..808500");
+
+	//window with one protein on each side of the seed: EAA26071.1 EAA26072.1 EAA26073.1
+	my_store.set_seed_window(1);
+	GenomicNeighborhood my_neighborhood (my_store, 0);
+	std::cout << "proteins in the window: " << my_neighborhood.protein_count() << "\n";
+	for(int i = 0; i < my_neighborhood.protein_count(); i++)
+		std::cout << my_neighborhood.get_pid(i) << " ";
+	std::cout << "\nseed at " << my_neighborhood.seed_index() << ": " << my_neighborhood.get_pid(my_neighborhood.seed_index()) << "\n";
+	std::cout << "neighborhood: " << my_neighborhood.get_first_cds() << ".." << my_neighborhood.get_last_cds() << "\n";
+}
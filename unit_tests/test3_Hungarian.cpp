@@ -0,0 +1,36 @@
+#include "../src/Hungarian.h"
+
+static int total_utility(Hungarian &hungarian) {
+  assignments_t foo = hungarian.get_assignments();
+  int total = 0;
+  for (assignments_t::iterator it = foo.begin(); it != foo.end(); ++it)
+  	total += it->second;
+  return total;
+}
+
+int main() {
+  /* two overlapping windows (rows 0-2 and 1-3) against the same columns:
+     the second one is warm started from the column potentials of the first */
+  int r[4*3] = {5, 0, 9, 7, 3, 0, 0, 8, 2, 6, 1, 4};
+  hungarian_matrix_t first(3, arena_vector<int>(3)), second(3, arena_vector<int>(3));
+
+  for (int i = 0; i < 3; i++)
+  	for (int j = 0; j < 3; j++) {
+  		first[i][j] = r[3*i + j];
+  		second[i][j] = r[3*(i + 1) + j];
+  	}
+
+  Hungarian hungarian(first, 3, 3, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+  hungarian.solve();
+
+  Hungarian cold(second, 3, 3, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+  cold.solve();
+  Hungarian warm(second, 3, 3, HUNGARIAN_MODE_MAXIMIZE_UTIL);
+  const arena_vector<int> &potentials = hungarian.column_potentials();
+  warm.set_column_potentials(std::vector<int>(potentials.begin(), potentials.end()));
+  warm.solve();
+
+  fprintf(stderr, "first window: %d (expected 24)\n", total_utility(hungarian));
+  fprintf(stderr, "second window: %d cold, %d warm (expected 19)\n", total_utility(cold), total_utility(warm));
+  return total_utility(hungarian) == 24 && total_utility(cold) == 19 && total_utility(warm) == 19 ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+#include "AccessionCodec.h"
+#include <iostream>
+
+int main() {
+    AccessionCodec my_codec;
+    std::string accessions[8] = {"EAA26069.1", "WP_012345678.1", "NP_000001", "P12345", "AAA00000.6",
+                                 "A0A023GPI8", "WP_012345678.10", "contig_1|gene_7"};
+    unsigned long long keys[8];
+
+    /* the first five are packed (bit 63 clear), the others go to the fallback table */
+    for (int i = 0; i < 8; i++) {
+        keys[i] = my_codec.encode(accessions[i]);
+        std::cout << accessions[i] << " " << ((keys[i] & AccessionCodec::FALLBACK) ? "fallback" : "packed") << " "
+                  << my_codec.decode(keys[i]) << "\n";
+    }
+
+    /* keys are stable and distinct */
+    unsigned long long key;
+    int same = 0;
+    for (int i = 0; i < 8; i++)
+        same += my_codec.find(accessions[i], key) && key == keys[i] && my_codec.encode(accessions[i]) == keys[i];
+    std::cout << "stable: " << same << " of 8 (expected 8)\n";
+    std::cout << "WP_12345678.1 differs from WP_012345678.1: " << (my_codec.encode("WP_12345678.1") != keys[1]) << " (expected 1)\n";
+    std::cout << "unknown irregular found: " << my_codec.find("XYZ-1", key) << " (expected 0)\n";
+}
@@ -0,0 +1,28 @@
+#include "../src/Arena.h"
+#include <iostream>
+
+int main() {
+	Arena my_arena (4096);
+
+	/* containers created in the scope of the arena don't touch the heap once its first block exists */
+	{
+		Arena::Scope scope(&my_arena);
+		for (int pair = 0; pair < 3; pair++) {
+			unsigned long long allocations = heap_allocation_count();
+			arena_vector<arena_vector<int> > matrix(10, arena_vector<int>(10, pair));
+			assignments_t assignments;
+			for (int i = 0; i < 10; i++)
+				assignments[std::make_pair(i, 9 - i)] = matrix[i][9 - i];
+			assignments.clear();
+			matrix.clear();
+			my_arena.reset();
+			if (pair > 0)
+				std::cout << "pair " << pair << ": " << heap_allocation_count() - allocations << " heap allocations (expected 0)\n";
+		}
+	}
+
+	/* outside a scope the allocator uses the heap */
+	arena_vector<int> heap_vector(10, 1);
+	std::cout << "heap vector in arena: " << (heap_vector.get_allocator().arena != NULL) << " (expected 0)\n";
+	std::cout << "arena capacity: " << my_arena.capacity() << " (expected 4096)\n";
+}
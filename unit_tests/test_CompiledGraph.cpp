@@ -0,0 +1,65 @@
+#include "../src/CompiledGraph.h"
+#include <fstream>
+
+int main() {
+	std::ofstream file("test_similarities.txt");
+	file << "EAA26069.1 EAA26072.1 40\n"
+	     << "EAA26072.1 contig_1|gene_7 10\n"
+	     << "EAA26072.1 EAA26069.1 99\n"       //repeated pair: the first similarity is kept
+	     << "contig_1|gene_7 contig_1|gene_7 25\n"
+	     << "WP_000000001.1 EAA26069.1 5\n";
+	file.close();
+
+	CompiledGraph::compile("test_similarities.txt", "test_similarities.graph");
+	std::cout << "is compiled: " << CompiledGraph::is_compiled("test_similarities.graph") << " "
+	          << CompiledGraph::is_compiled("test_similarities.txt") << " (expected 1 0)\n";
+
+	CompiledGraph my_graph;
+	my_graph.open("test_similarities.graph");
+	std::cout << "proteins: " << my_graph.protein_count() << " similarities: " << my_graph.similarity_count()
+	          << " max: " << my_graph.max_similarity() << " (expected 4 4 40)\n";
+
+	//ids in order of first appearance, as in a ProteinCollection
+	const char *pids[] = {"EAA26069.1", "EAA26072.1", "contig_1|gene_7", "WP_000000001.1", "absent.1", "absent|gene"};
+	for (int i = 0; i < 6; i++) {
+		long id = my_graph.find(pids[i]);
+		std::cout << pids[i] << " -> " << id;
+		if (id >= 0) std::cout << " -> " << my_graph.name(id);
+		std::cout << "\n";
+	}
+
+	for (long id = 0; id < my_graph.protein_count(); id++) {
+		std::cout << my_graph.name(id) << ":";
+		for (long k = 0; k < my_graph.degree(id); k++)
+			std::cout << " " << my_graph.name(my_graph.neighbors_of(id)[k]) << "=" << my_graph.weights_of(id)[k];
+		std::cout << "\n";
+	}
+
+	//A segment with a new protein, a changed similarity and one that is already in the graph
+	std::ofstream delta("test_delta.txt");
+	delta << "EAA26069.1 EAA26072.1 45\n"
+	      << "new|gene_1 EAA26069.1 7\n"
+	      << "contig_1|gene_7 EAA26072.1 10\n";
+	delta.close();
+	std::cout << "appended: " << CompiledGraph::append("test_delta.txt", "test_similarities.graph") << " (expected 2)\n";
+
+	CompiledGraph appended;
+	appended.open("test_similarities.graph");
+	std::cout << "segments: " << appended.segment_count() << " proteins: " << appended.protein_count()
+	          << " similarities: " << appended.similarity_count() << " max: " << appended.max_similarity()
+	          << " (expected 1 5 5 45)\n";
+	std::cout << "new|gene_1 -> " << appended.find("new|gene_1") << " -> " << appended.name(4) << " (expected 4)\n";
+	std::cout << "EAA26069.1 EAA26072.1 = " << appended.similarity(0, 1) << " (expected 45)\n";
+
+	CompiledGraph::compact("test_similarities.graph");
+	CompiledGraph compacted;
+	compacted.open("test_similarities.graph");
+	std::cout << "compacted segments: " << compacted.segment_count() << " proteins: " << compacted.protein_count()
+	          << " similarities: " << compacted.similarity_count() << " (expected 0 5 5)\n";
+	for (long id = 0; id < compacted.protein_count(); id++) {
+		std::cout << compacted.name(id) << ":";
+		for (long k = 0; k < compacted.degree(id); k++)
+			std::cout << " " << compacted.name(compacted.neighbors_of(id)[k]) << "=" << compacted.weights_of(id)[k];
+		std::cout << "\n";
+	}
+}
@@ -0,0 +1,17 @@
+#include "../src/HopcroftKarp.h"
+#include <iostream>
+
+int main() {
+	/* left 0 can only take right 0, so left 1 must move to right 1 */
+	HopcroftKarp my_matching (3, 3);
+	my_matching.add_edge(0, 0);
+	my_matching.add_edge(1, 0);
+	my_matching.add_edge(1, 1);
+	my_matching.add_edge(2, 1);
+
+	std::cout << "matching size: " << my_matching.solve() << " (expected 2)\n";
+
+	arena_vector<int> matching = my_matching.get_matching();
+	for (unsigned int i = 0; i < matching.size(); i++)
+		std::cout << i << " -> " << matching[i] << "\n";
+}
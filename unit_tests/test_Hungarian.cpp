@@ -3,7 +3,7 @@
 int main() {
 	  /* an example cost matrix */
   int r[3*3] =  {20,90,10,60,30,40,90,90, 120};
-  std::vector< std::vector<int> > m;
+  hungarian_matrix_t m;
   int k = 0;
 
   m.resize(3);
@@ -30,10 +30,10 @@ int main() {
   fprintf(stderr, "assignment:");
   hungarian.print_assignment();
 
-  std::map<std::pair<int, int>,int> foo;
+  assignments_t foo;
   foo = hungarian.get_assignments();
 
-  for (std::map<std::pair<int, int>,int>::iterator it = foo.begin(); it != foo.end(); ++it)
+  for (assignments_t::iterator it = foo.begin(); it != foo.end(); ++it)
   	fprintf(stderr, "%d ",it->second);
   fprintf(stderr, "\n");
 
@@ -0,0 +1,58 @@
+#include "../src/NeighborhoodIndex.h"
+#include <fstream>
+
+int main() {
+	std::ofstream file("test_neighborhoods.txt");
+	file << "ORGANISM  Rickettsia sibirica  accession no is AABW01000001.1 Protein is EAA26072.1\n"
+	     << ".   cds                dir len   pid                  type   gene     locus                gi         product\n"
+	     << ".   803087..804568     -   493   EAA26069.1           CDS    .        rsib_orf877          .          hypothetical protein\n"
+	     << "-->   807002..807619   +   205   EAA26072.1           CDS    .        rsib_orf880          .          ribosomal protein L4\n"
+	     << ".   807652..807909     +   85    absent|gene_1        CDS    .        rsib_orf881          .          unknown\n"
+	     << "ORGANISM  Rickettsia conorii  accession no is AE006914.1 Protein is EAA26072.1\n"
+	     << ".   cds                dir len   pid                  type   gene     locus                gi         product\n"
+	     << "-->   1000..1617       +   205   EAA26072.1           CDS    .        RC0001               .          ribosomal protein L4\n"
+	     << ".   1700..2000         +   100   EAA26072.1           CDS    .        RC0002               .          ribosomal protein L4\n";
+	file.close();
+
+	std::ofstream similarities("test_similarities.txt");
+	similarities << "EAA26069.1 EAA26072.1 40\n"
+	             << "EAA26072.1 contig_1|gene_7 10\n";
+	similarities.close();
+	CompiledGraph::compile("test_similarities.txt", "test_similarities.graph");
+	CompiledGraph graph;
+	graph.open("test_similarities.graph");
+
+	NeighborhoodStore my_store;
+	my_store.load("test_neighborhoods.txt");
+	NeighborhoodIndex::build(my_store, graph, "test_neighborhoods.index");
+
+	NeighborhoodIndex my_index;
+	my_index.open("test_neighborhoods.index", graph);
+	std::cout << "neighborhoods: " << my_index.size() << " proteins: " << my_index.protein_count(0) << " "
+	          << my_index.protein_count(1) << " (expected 2 3 2)\n";
+
+	//A neighborhood is posted once under each of its proteins
+	for (long id = 0; id < graph.protein_count(); id++) {
+		std::cout << graph.name(id) << ":";
+		for (unsigned long long p = 0; p < my_index.posting_count(id); p++)
+			std::cout << " " << my_index.postings(id)[p];
+		std::cout << "\n";
+	}
+	std::cout << "(expected EAA26069.1: 0, EAA26072.1: 0 1, contig_1|gene_7:)\n";
+
+	NeighborhoodStore partners;
+	my_index.add_to(partners, 1, graph);
+	my_index.add_to(partners, 0, graph);
+	for (unsigned int n = 0; n < partners.size(); n++) {
+		std::cout << partners.get_accession(n) << " " << partners.get_first_cds(n) << ".." << partners.get_last_cds(n)
+		          << " seed at " << partners.seed_index(n) << ":";
+		for (int i = 0; i < partners.protein_count(n); i++) {
+			std::string pid;
+			partners.append_pid(pid, partners.first_protein(n) + i);
+			std::cout << " " << pid;
+		}
+		std::cout << "\n";
+	}
+	std::cout << "(expected AE006914.1 1000..2000 seed at 0: EAA26072.1 EAA26072.1, "
+	          << "AABW01000001.1 803087..807909 seed at 1: EAA26069.1 EAA26072.1 .)\n";
+}
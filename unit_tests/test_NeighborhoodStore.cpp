@@ -0,0 +1,44 @@
+#include "../src/NeighborhoodStore.h"
+#include <fstream>
+
+int main() {
+	std::ofstream file("test_neighborhoods.txt");
+	file << "ORGANISM  Rickettsia sibirica  accession no is AABW01000001.1 Protein is EAA26072.1\n"
+	     << ".   cds                dir len   pid                  type   gene     locus                gi         product\n"
+	     << ".   803087..804568     -   493   EAA26069.1           CDS    .        rsib_orf877          .          hypothetical protein\n"
+	     << "-->   807002..807619   +   205   EAA26072.1           CDS    .        rsib_orf880          .          ribosomal protein L4\n"
+	     << ".   807652..807909     +   85    contig_1|gene_7      CDS    .        rsib_orf881          .          unknown\n"
+	     << "ORGANISM  Rickettsia conorii  accession no is AE006914.1 Protein is EAA26072.1\n"
+	     << ".   cds                dir len   pid                  type   gene     locus                gi         product\n"
+	     << "-->   1000..1617       +   205   EAA26072.1           CDS    .        RC0001               .          ribosomal protein L4\n";
+	file.close();
+
+	NeighborhoodStore my_store;
+	my_store.load("test_neighborhoods.txt");
+	std::cout << "neighborhoods: " << my_store.size() << " proteins: " << my_store.total_proteins()
+	          << " unique: " << my_store.unique_protein_count() << " (expected 2 4 3)\n";
+
+	for (unsigned int n = 0; n < my_store.size(); n++) {
+		std::cout << my_store.get_accession(n) << " " << my_store.get_first_cds(n) << ".." << my_store.get_last_cds(n)
+		          << " seed at " << my_store.seed_index(n) << ":\n";
+		for (int i = 0; i < my_store.protein_count(n); i++) {
+			std::string pid;
+			my_store.append_pid(pid, my_store.first_protein(n) + i);
+			std::cout << "  " << pid << " " << my_store.get_locus(n, i) << " " << my_store.get_product(n, i) << "\n";
+		}
+	}
+
+	//the seed alone: the loci are still read from the window
+	my_store.set_seed_window(0);
+	std::cout << "window of " << my_store.protein_count(0) << ": " << my_store.get_locus(0, 0) << " (expected 1: rsib_orf880)\n";
+
+	//a second file: its neighborhoods come after the others, and each one is read back from its own file
+	std::ofstream reference("test_reference.txt");
+	reference << "ORGANISM  Rickettsia rickettsii  accession no is CP000766.3 Protein is EAA26072.1\n"
+	          << ".   cds                dir len   pid                  type   gene     locus                gi         product\n"
+	          << "-->   5000..5617       +   205   EAA26072.1           CDS    .        A1G_00001            .          ribosomal protein L4\n";
+	reference.close();
+	my_store.load("test_reference.txt");
+	std::cout << "neighborhoods: " << my_store.size() << ", loci: " << my_store.get_locus(1, 0) << " "
+	          << my_store.get_locus(2, 0) << " (expected 3, loci: RC0001 A1G_00001)\n";
+}
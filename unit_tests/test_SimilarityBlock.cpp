@@ -0,0 +1,42 @@
+#include "../src/SimilarityBlock.h"
+#include "../src/NeighborhoodStore.h"
+
+int main() {
+	NeighborhoodStore my_store;
+	ProteinCollection my_graph (4);
+	SimilarityBlock block;
+
+	my_store.add_neighborhood("AABW01000001.1");
+	my_store.add_protein("EAA26069.1", "803087..804568");
+	my_store.add_protein("EAA26070.1", "804722..806695");
+	my_store.add_neighborhood("AAFJ01000001.1");
+	my_store.add_protein("EAA26071.1", "806695..807009");
+	my_store.add_protein("EAA26072.1", "807002..807619");
+	my_store.add_protein("EAA26073.1", "807652..807909");
+
+	my_graph.add_protein("EAA26069.1");
+	my_graph.add_protein("EAA26070.1");
+	my_graph.add_protein("EAA26071.1");
+	my_graph.add_protein("EAA26073.1");
+	my_graph.connect_proteins("EAA26069.1", "EAA26071.1", 0.5);
+	my_graph.connect_proteins("EAA26070.1", "EAA26073.1", 0.25);
+
+	my_store.resolve(my_graph);
+	block.fill(GenomicNeighborhood(my_store, 0), GenomicNeighborhood(my_store, 1), my_graph);
+	std::cout << block.rows() << "x" << block.cols() << "\n";
+	for (int i = 0; i < block.rows(); i++) {
+		for (int j = 0; j < block.cols(); j++)
+			std::cout << block.at(i, j) << " ";
+		std::cout << "\n";
+	}
+
+	//last protein of g1 against the last two of g2
+	SimilarityBlock window;
+	window.view(block, 1, 1, 1, 2);
+	std::cout << window.rows() << "x" << window.cols() << "\n";
+	for (int i = 0; i < window.rows(); i++) {
+		for (int j = 0; j < window.cols(); j++)
+			std::cout << window.at(i, j) << " ";
+		std::cout << "\n";
+	}
+}
@@ -0,0 +1,30 @@
+#include "../src/SparseMatching.h"
+#include <iostream>
+
+int main() {
+	/* the heaviest edge (0,0) must be given up: (0,1) + (1,0) weighs more */
+	SparseMatching my_matching (2, 2);
+	my_matching.add_edge(0, 0, 60);
+	my_matching.add_edge(0, 1, 50);
+	my_matching.add_edge(1, 0, 40);
+
+	std::cout << "upper bound: " << my_matching.upper_bound() << " (expected 100)\n";
+	std::cout << "matching weight: " << my_matching.solve() << " (expected 90)\n";
+
+	assignments_t assignments = my_matching.get_assignments();
+	for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
+		std::cout << it->first.first << " " << it->first.second << " " << it->second << "\n";
+
+	/* left vertex 2 and right vertex 1 are left unmatched: paired with padding (2,5) and (4,1) */
+	SparseMatching my_padded (3, 3);
+	my_padded.add_edge(0, 0, 10);
+	my_padded.add_edge(1, 2, 20);
+	my_padded.add_edge(2, 2, 5);
+
+	std::cout << "matching weight: " << my_padded.solve() << " (expected 30)\n";
+
+	assignments = my_padded.get_assignments();
+	for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
+		std::cout << it->first.first << " " << it->first.second << " " << it->second << "\n";
+	std::cout << "(expected 0 0 10, 1 2 20, 2 5 0, 4 1 0)\n";
+}
@@ -0,0 +1,80 @@
+#include "../src/colinear_scoring.h"
+#include "../src/ProteinCollection.h"
+#include <cmath>
+
+/*Returns the weight of the best local alignment with the plain O(nm) table, one cell at a time*/
+static double reference_alignment(const SimilarityBlock &block, double prot_stringency, double gap_penalty,
+                                  bool reverse) {
+	std::vector<std::vector<double> > h(block.rows() + 1, std::vector<double>(block.cols() + 1, 0));
+	double best = 0;
+	for (int i = 1; i <= block.rows(); i++)
+		for (int j = 1; j <= block.cols(); j++) {
+			double w = block.at(i - 1, reverse ? block.cols() - j : j - 1);
+			if (w < prot_stringency) w = 0;
+			h[i][j] = std::max(std::max(h[i - 1][j - 1] + w, h[i - 1][j] - gap_penalty),
+			                   std::max(h[i][j - 1] - gap_penalty, 0.0));
+			best = std::max(best, h[i][j]);
+		}
+	return best;
+}
+
+/*Returns the weight of an alignment given by its aligned proteins: their similarities minus the proteins left unpaired
+ *between them (paired with weight 0 as far as possible), or -1 if they are not in order*/
+static double alignment_weight(const SimilarityBlock &block, const assignments_t &assignments, double gap_penalty,
+                               bool reverse) {
+	double weight = 0;
+	int last_i = -1, last_j = -1;
+	for (assignments_t::const_iterator it = assignments.begin(); it != assignments.end(); ++it) {
+		int i = it->first.first, j = reverse ? block.cols() - 1 - it->first.second : it->first.second;
+		if (last_i >= 0 && j <= last_j) return -1;
+		if (last_i >= 0) weight -= gap_penalty*std::abs((i - last_i) - (j - last_j));
+		weight += block.at(it->first.first, it->first.second);
+		last_i = i;
+		last_j = j;
+	}
+	return weight;
+}
+
+int main() {
+	//Random blocks of 1 to 13 rows and columns (most not multiples of the vector width) over 26 proteins
+	unsigned int random = 2024;
+	ProteinCollection my_graph (26);
+	for (int p = 0; p < 26; p++)
+		my_graph.add_protein("P" + std::to_string(p));
+	for (int p = 0; p < 13; p++)
+		for (int q = 13; q < 26; q++)
+			if ((random = random*1103515245 + 12345) % 10 < 4)
+				my_graph.connect_proteins("P" + std::to_string(p), "P" + std::to_string(q), 0.05 + ((random >> 16) % 95)/100.0);
+	long indexes[26];
+	for (int p = 0; p < 26; p++)
+		indexes[p] = my_graph.get_index("P" + std::to_string(p));
+
+	int trials = 0, same_weight = 0, same_alignment = 0;
+	double gap_penalties[2] = {0, 0.15};
+	for (int t = 0; t < 100; t++) {
+		int rows = 1 + (random = random*1103515245 + 12345) % 13;
+		int cols = 1 + (random = random*1103515245 + 12345) % 13;
+		SimilarityBlock block;
+		block.fill(indexes, rows, indexes + 13, cols, my_graph);
+
+		for (int g = 0; g < 2; g++)
+			for (int reverse = 0; reverse < 2; reverse++) {
+				double expected = reference_alignment(block, 0.1, gap_penalties[g], false);
+				bool expected_reverse = false;
+				if (reverse && reference_alignment(block, 0.1, gap_penalties[g], true) > expected) {
+					expected = reference_alignment(block, 0.1, gap_penalties[g], true);
+					expected_reverse = true;
+				}
+
+				assignments_t assignments;
+				double weight = colinear_alignment(block, 0.1, gap_penalties[g], reverse, assignments);
+				trials++;
+				if (std::fabs(weight - expected) < 1e-9)
+					same_weight++;
+				if (std::fabs(alignment_weight(block, assignments, gap_penalties[g], expected_reverse) - expected) < 1e-9)
+					same_alignment++;
+			}
+	}
+	std::cout << "weights equal to the scalar reference: " << same_weight << "/" << trials << " (expected 400/400)\n";
+	std::cout << "alignments reaching that weight: " << same_alignment << "/" << trials << " (expected 400/400)\n";
+}
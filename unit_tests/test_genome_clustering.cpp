@@ -0,0 +1,343 @@
+#include "../src/genome_grouping.h"
+#include <fstream>
+#include <sstream>
+#include <regex>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*Returns the contents of a file*/
+static std::string read_file(const std::string &filename) {
+	std::ifstream file(filename.c_str());
+	std::stringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
+
+/*Returns the contents of a file with its records (lines, or a line starting with '>' and the ones after it) sorted, and
+ *the suffixes of the protein ids ("_" and a number) removed*/
+static std::string sorted_records(const std::string &filename) {
+	std::ifstream file(filename.c_str());
+	std::vector<std::string> records;
+	std::string line;
+	while (std::getline(file, line)) {
+		line = std::regex_replace(line, std::regex("_[0-9]+"), "");
+		if (records.empty() || line[0] == '>' || records.back()[0] != '>')
+			records.push_back(line + "\n");
+		else
+			records.back() += line + "\n";
+	}
+	std::sort(records.begin(), records.end());
+	std::string contents;
+	for (unsigned int i = 0; i < records.size(); i++)
+		contents += records[i];
+	return contents;
+}
+
+/*Methods of the runs compared with each other, and their outputs*/
+static const std::string METHODS = "porthodom,porthodomO2,porthodomO3,porthodom-count,colinear";
+static const std::string METHOD_NAMES[5] = {"porthodom", "porthodomO2", "porthodomO3", "porthodom-count", "colinear"};
+
+/*Writes count neighborhoods (accessions NB<n>, from NB<first> on) of length proteins from a pool of pool_size proteins,
+ *each with a seed, to a neighborhoods file. The same random state writes the same neighborhoods*/
+static void write_neighborhoods(unsigned int &random, const std::string &filename, int first, int count, int length,
+                                int pool_size) {
+	std::ofstream file(filename.c_str());
+	for (int n = first; n < first + count; n++) {
+		file << "ORGANISM  Org " << n << "  accession no is NB" << n << " Protein is P0\n"
+		     << ".   cds     dir len   pid     type   gene     locus     gi         product\n";
+		int seed = (random = random*1103515245 + 12345) % length;
+		for (int i = 0; i < length; i++) {
+			random = random*1103515245 + 12345;
+			file << (i == seed ? "-->" : ".") << "   " << 1000*i << ".." << 1000*i + 900 << "   -   300   P"
+			     << (random >> 16) % pool_size << "   CDS   .   loc   .   prod\n";
+		}
+	}
+}
+
+/*Writes random similarities between about 30% of the pairs of a pool of pool_size proteins to a similarities file,
+ *then changes (sets to a new random value or removes) changes of them. The same random state writes the same ones*/
+static void write_similarities(unsigned int random, const std::string &filename, int pool_size, int changes) {
+	std::vector<std::vector<double> > similarities(pool_size, std::vector<double>(pool_size, 0));
+	for (int p = 0; p < pool_size; p++)
+		for (int q = p + 1; q < pool_size; q++)
+			if ((random = random*1103515245 + 12345) % 10 < 3)
+				similarities[p][q] = 0.1 + ((random >> 16) % 90)/100.0;
+	for (int c = 0; c < changes; c++) {
+		int p = (random = random*1103515245 + 12345) % pool_size;
+		int q = (random = random*1103515245 + 12345) % pool_size;
+		random = random*1103515245 + 12345;
+		similarities[std::min(p, q)][std::max(p, q)] = p == q || (random >> 16) % 3 == 0 ? 0 : 0.1 + ((random >> 16) % 90)/100.0;
+	}
+
+	std::ofstream file(filename.c_str());
+	for (int p = 0; p < pool_size; p++)
+		for (int q = p + 1; q < pool_size; q++)
+			if (similarities[p][q] > 0)
+				file << "P" << p << " P" << q << " " << similarities[p][q] << "\n";
+}
+
+/*Returns "same" if the runs with the given outputs wrote the same outputs and pairings for every method (with their
+ *records sorted if sorted is set), "different" otherwise*/
+static std::string compare_runs(const std::string &output1, const std::string &pairings1, const std::string &output2,
+                                const std::string &pairings2, bool sorted) {
+	for (int k = 0; k < 5; k++) {
+		std::string suffix = "." + METHOD_NAMES[k];
+		if (sorted ? sorted_records(output1 + suffix) != sorted_records(output2 + suffix) ||
+		             sorted_records(pairings1 + suffix) != sorted_records(pairings2 + suffix) :
+		             read_file(output1 + suffix) != read_file(output2 + suffix) ||
+		             read_file(pairings1 + suffix) != read_file(pairings2 + suffix))
+			return "different";
+	}
+	return "same";
+}
+
+/*Sends a request line to a connection to genome_clustering_serve and returns its response, without the empty line
+ *that ends it*/
+static std::string serve_request(int connection, const std::string &request) {
+	std::string line = request + "\n", response;
+	if (write(connection, line.data(), line.size()) != (ssize_t)line.size())
+		return "ERROR: trouble sending the request\n";
+	char chunk[4096];
+	while (response != "\n" && (response.size() < 2 || response.compare(response.size() - 2, 2, "\n\n") != 0)) {
+		ssize_t bytes = read(connection, chunk, sizeof(chunk));
+		if (bytes <= 0) break;
+		response.append(chunk, bytes);
+	}
+	return response.substr(0, response.size() - 1);
+}
+
+int main() {
+	//Neighborhoods of 6 proteins from a pool of 30, each with a seed, and random similarities between the proteins
+	unsigned int random = 12345;
+	NeighborhoodStore my_store;
+	for (int n = 0; n < 40; n++) {
+		my_store.add_neighborhood("ACC" + std::to_string(n));
+		int seed = (random = random*1103515245 + 12345) % 6;
+		for (int i = 0; i < 6; i++) {
+			random = random*1103515245 + 12345;
+			my_store.add_protein("P" + std::to_string((random >> 16) % 30), std::to_string(1000*i) + ".." + std::to_string(1000*i + 900));
+			if (i == seed)
+				my_store.add_seed();
+		}
+	}
+	ProteinCollection my_graph (30);
+	for (int p = 0; p < 30; p++)
+		my_graph.add_protein("P" + std::to_string(p));
+	for (int p = 0; p < 30; p++)
+		for (int q = p + 1; q < 30; q++)
+			if ((random = random*1103515245 + 12345) % 10 < 3)
+				my_graph.connect_proteins("P" + std::to_string(p), "P" + std::to_string(q), 0.1 + ((random >> 16) % 90)/100.0);
+
+	clustering_options_t options = clustering_options_t();
+	options.seed_window = -1;
+	options.seed_anchor = true;
+	options.threads = 1;
+	options.shards = 1;
+
+	//With --seed_anchor, the porthodom result must not prune the order-aware methods run with it
+	std::string methods[3] = {"porthodom", "porthodomO2", "porthodomO3"};
+	genome_clustering(my_store, my_graph, "porthodom,porthodomO2,porthodomO3", 0.1, 0.2, "test_combined",
+	                  "test_combined_pairings", options);
+	for (int k = 0; k < 3; k++) {
+		genome_clustering(my_store, my_graph, methods[k], 0.1, 0.2, "test_single", "test_single_pairings", options);
+		std::string combined = read_file("test_combined." + methods[k]), single = read_file("test_single");
+		std::cout << methods[k] << ": " << (combined == single ? "same" : "different") << " ("
+		          << std::count(single.begin(), single.end(), '\n') << " pairs), pairings: "
+		          << (read_file("test_combined_pairings." + methods[k]) == read_file("test_single_pairings") ? "same" : "different")
+		          << " (expected same)\n";
+	}
+
+	//Neighborhoods copied from 10 templates are compared once for each pair of templates. They must give the same
+	//results as neighborhoods made distinct by giving each one its own copy of the proteins (P3_7 is P3 in the
+	//neighborhood 7), with the same similarities
+	double similarities[30][30];
+	for (int p = 0; p < 30; p++)
+		for (int q = 0; q < 30; q++)
+			similarities[p][q] = my_graph.get_similarity("P" + std::to_string(p), "P" + std::to_string(q));
+	int templates[10][6];
+	for (int t = 0; t < 10; t++)
+		for (int i = 0; i < 6; i++)
+			templates[t][i] = (random = random*1103515245 + 12345) % 30;
+	NeighborhoodStore duplicates, distinct;
+	ProteinCollection distinct_graph (60*6);
+	std::vector<int> copies; //protein of the pool of each protein of distinct_graph
+	for (int n = 0; n < 60; n++) {
+		int t = (random = random*1103515245 + 12345) % 10;
+		duplicates.add_neighborhood("DUP" + std::to_string(n));
+		distinct.add_neighborhood("DUP" + std::to_string(n));
+		for (int i = 0; i < 6; i++) {
+			std::string cds = std::to_string(1000*i) + ".." + std::to_string(1000*i + 900);
+			std::string copy = "P" + std::to_string(templates[t][i]) + "_" + std::to_string(n);
+			duplicates.add_protein("P" + std::to_string(templates[t][i]), cds);
+			distinct.add_protein(copy, cds);
+			if (distinct_graph.get_index(copy) < 0) {
+				distinct_graph.add_protein(copy);
+				copies.push_back(templates[t][i]);
+			}
+		}
+	}
+	for (unsigned int p = 0; p < copies.size(); p++)
+		for (unsigned int q = p + 1; q < copies.size(); q++)
+			if (similarities[copies[p]][copies[q]] > 0)
+				distinct_graph.connect_proteins((long)p, (long)q, similarities[copies[p]][copies[q]]);
+
+	std::string all_methods[5] = {"porthodom", "porthodomO2", "porthodomO3", "porthodom-count", "colinear"};
+	options.seed_anchor = false;
+	genome_clustering(distinct, distinct_graph, "porthodom,porthodomO2,porthodomO3,porthodom-count,colinear", 0.1, 0.2,
+	                  "test_distinct", "test_distinct_pairings", options);
+	for (int threads = 1; threads <= 4; threads += 3) {
+		options.threads = threads;
+		genome_clustering(duplicates, my_graph, "porthodom,porthodomO2,porthodomO3,porthodom-count,colinear", 0.1, 0.2,
+		                  "test_duplicates", "test_duplicates_pairings", options);
+		for (int k = 0; k < 5; k++)
+			std::cout << all_methods[k] << " with " << threads << " thread(s), duplicates: "
+			          << (sorted_records("test_duplicates." + all_methods[k]) == sorted_records("test_distinct." + all_methods[k]) ?
+			              "same" : "different")
+			          << ", pairings: " << (sorted_records("test_duplicates_pairings." + all_methods[k]) ==
+			                                sorted_records("test_distinct_pairings." + all_methods[k]) ? "same" : "different")
+			          << " (expected same)\n";
+	}
+
+	//Mini fixture of files for the modes below, compared with a single run of genome_clustering on it
+	unsigned int fixture_random = 777;
+	write_neighborhoods(fixture_random, "test_fixture_neighborhoods", 0, 80, 8, 40);
+	unsigned int similarities_random = fixture_random;
+	write_similarities(similarities_random, "test_fixture_similarities", 40, 0);
+	NeighborhoodStore fixture = parse_neighborhoods("test_fixture_neighborhoods");
+	ProteinCollection fixture_graph = protein_clustering("test_fixture_similarities", total_protein_count(fixture));
+	options = clustering_options_t();
+	options.seed_window = -1;
+	options.threads = 1;
+	options.shards = 1;
+	genome_clustering(fixture, fixture_graph, METHODS, 0.1, 0.3, "test_run", "test_run_pairings", options);
+
+	//Shards 0 to 2, merged, are the single run
+	options.shards = 3;
+	for (options.shard = 0; options.shard < 3; options.shard++)
+		genome_clustering(fixture, fixture_graph, METHODS, 0.1, 0.3, shard_filename("test_shards", options.shard),
+		                  shard_filename("test_shards_pairings", options.shard), options);
+	merge_shards(METHODS, "test_shards", "test_shards_pairings", 3);
+	std::cout << "3 shards merged: " << compare_runs("test_shards", "test_shards_pairings", "test_run", "test_run_pairings", false)
+	          << " (expected same)\n";
+	options.shard = 0;
+	options.shards = 1;
+
+	//A run killed after a checkpoint and resumed from it is the single run (a larger fixture, so it runs long enough)
+	write_neighborhoods(fixture_random, "test_large_neighborhoods", 0, 200, 16, 150);
+	write_similarities(fixture_random, "test_large_similarities", 150, 0);
+	NeighborhoodStore large = parse_neighborhoods("test_large_neighborhoods");
+	ProteinCollection large_graph = protein_clustering("test_large_similarities", total_protein_count(large));
+	genome_clustering(large, large_graph, METHODS, 0.1, 0.3, "test_large", "test_large_pairings", options);
+
+	std::remove("test_checkpoint.ckpt");
+	options.checkpoint_interval = 1;
+	options.threads = 2;
+	std::cout.flush();
+	pid_t child = fork();
+	if (child == 0) {
+		genome_clustering(large, large_graph, METHODS, 0.1, 0.3, "test_checkpoint", "test_checkpoint_pairings", options);
+		_exit(0);
+	}
+	bool killed = false;
+	while (waitpid(child, NULL, WNOHANG) == 0) {
+		if (std::ifstream("test_checkpoint.ckpt").good()) {
+			kill(child, SIGKILL);
+			waitpid(child, NULL, 0);
+			killed = true;
+			break;
+		}
+		usleep(10000);
+	}
+	options.resume = true;
+	genome_clustering(large, large_graph, METHODS, 0.1, 0.3, "test_checkpoint", "test_checkpoint_pairings", options);
+	std::cout << "killed after a checkpoint: " << (killed ? "yes" : "no") << " (expected yes), resumed: "
+	          << compare_runs("test_checkpoint", "test_checkpoint_pairings", "test_large", "test_large_pairings", false)
+	          << " (expected same)\n";
+	options.checkpoint_interval = 0;
+	options.resume = false;
+	options.threads = 1;
+
+	//A run on the first 60 neighborhoods of the fixture, with the pairs of the other 20 added by an incremental run, is
+	//the single run (sorted: the new pairs come after the previous ones)
+	unsigned int previous_random = 777;
+	write_neighborhoods(previous_random, "test_previous_neighborhoods", 0, 60, 8, 40);
+	NeighborhoodStore previous = parse_neighborhoods("test_previous_neighborhoods");
+	genome_clustering(previous, fixture_graph, METHODS, 0.1, 0.3, "test_incremental", "test_incremental_pairings", options);
+	options.first_new = previous_neighborhoods(fixture, "test_previous_neighborhoods");
+	genome_clustering(fixture, fixture_graph, METHODS, 0.1, 0.3, "test_incremental", "test_incremental_pairings", options);
+	std::cout << "incremental run from neighborhood " << options.first_new << ": "
+	          << compare_runs("test_incremental", "test_incremental_pairings", "test_run", "test_run_pairings", true)
+	          << " (expected same)\n";
+	options.first_new = 0;
+
+	//The single run updated for 30 changes of the similarities is a run with the changed similarities
+	write_similarities(similarities_random, "test_changed_similarities", 40, 30);
+	CompiledGraph::compile("test_fixture_similarities", "test_fixture_similarities.graph");
+	CompiledGraph::compile("test_changed_similarities", "test_changed_similarities.graph");
+	CompiledGraph previous_graph, changed_graph;
+	previous_graph.open("test_fixture_similarities.graph");
+	changed_graph.open("test_changed_similarities.graph");
+	NeighborhoodStore updated = parse_neighborhoods("test_fixture_neighborhoods");
+	genome_clustering(updated, fixture_graph, METHODS, 0.1, 0.3, "test_update", "test_update_pairings", options);
+	genome_clustering_update(updated, previous_graph, changed_graph, false, METHODS, 0.1, 0.3, "test_update",
+	                         "test_update_pairings", options);
+	NeighborhoodStore changed = parse_neighborhoods("test_fixture_neighborhoods");
+	ProteinCollection changed_collection = protein_clustering("test_changed_similarities", total_protein_count(changed));
+	genome_clustering(changed, changed_collection, METHODS, 0.1, 0.3, "test_changed", "test_changed_pairings", options);
+	std::cout << "updated for the changed similarities: "
+	          << compare_runs("test_update", "test_update_pairings", "test_changed", "test_changed_pairings", false)
+	          << " (expected same), changed from the single run: "
+	          << compare_runs("test_update", "test_update_pairings", "test_run", "test_run_pairings", false)
+	          << " (expected different)\n";
+
+	//The fixture streamed (each neighborhood compared with the previous ones as it is read) is the single run, sorted
+	std::ifstream stream("test_fixture_neighborhoods");
+	genome_clustering_stream(stream, fixture_graph, METHODS, 0.1, 0.3, "test_stream", "test_stream_pairings", options);
+	std::cout << "streamed: " << compare_runs("test_stream", "test_stream_pairings", "test_run", "test_run_pairings", true)
+	          << " (expected same)\n";
+
+	//The scores of every pair and the partners of every neighborhood asked to a server of the fixture are those of the
+	//single run
+	std::remove("test_serve.sock");
+	std::cout.flush();
+	child = fork();
+	if (child == 0) {
+		NeighborhoodStore served = parse_neighborhoods("test_fixture_neighborhoods");
+		genome_clustering_serve(served, "test_fixture_similarities", false, "porthodom", 0.1, 0.3, "test_serve.sock", options);
+		_exit(0);
+	}
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, "test_serve.sock");
+	int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	for (int attempt = 0; attempt < 500 && connect(connection, (struct sockaddr *)&address, sizeof(address)) != 0; attempt++)
+		usleep(10000);
+
+	std::string scores;
+	std::vector<std::string> partners_lines, expected_lines;
+	for (int m = 0; m < 80; m++)
+		for (int n = m + 1; n < 80; n++)
+			scores += serve_request(connection, "score NB" + std::to_string(m) + " 0 NB" + std::to_string(n) + " 0");
+	for (int n = 0; n < 80; n++) {
+		std::istringstream partners(serve_request(connection, "top 80 NB" + std::to_string(n) + " 0"));
+		for (std::string line; std::getline(partners, line); )
+			partners_lines.push_back(line);
+	}
+	close(connection);
+	kill(child, SIGTERM);
+	waitpid(child, NULL, 0);
+
+	//Each pair of the single run is a partner of both of its neighborhoods
+	std::istringstream run(read_file("test_run.porthodom"));
+	for (std::string line; std::getline(run, line); ) {
+		expected_lines.push_back(line);
+		expected_lines.push_back(line);
+	}
+	std::sort(partners_lines.begin(), partners_lines.end());
+	std::sort(expected_lines.begin(), expected_lines.end());
+	std::cout << "served scores: " << (scores == read_file("test_run.porthodom") ? "same" : "different")
+	          << " (expected same), partners: " << (partners_lines == expected_lines ? "same" : "different")
+	          << " (expected same)\n";
+}
@@ -0,0 +1,67 @@
+#include "../src/porthodomO2_scoring.h"
+#include "../src/porthodom_scoring.h"
+
+/*Returns the total weight of the porthodomO2 assignments solved as before on a matrix with a column for every
+ *protein of g2: the last one is never filled and stays 0*/
+static long long baseline_total(const SimilarityBlock &block, double prot_stringency) {
+	hungarian_matrix_t matrix(block.rows() - 1, arena_vector<int>(block.cols(), 0));
+	for (int i = 0; i < block.rows() - 1; i++)
+		for (int j = 0; j < block.cols() - 1; j++) {
+			double result = (block.at(i, j) + block.at(i + 1, j + 1))/2;
+			matrix[i][j] = result >= prot_stringency ? (int)(1000000*result) : 0;
+		}
+	Hungarian my_hungarian (matrix, matrix.size(), matrix[0].size(), HUNGARIAN_MODE_MAXIMIZE_UTIL);
+	my_hungarian.solve();
+	assignments_t assignments = my_hungarian.get_assignments();
+	long long total = 0;
+	for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
+		total += it->second;
+	return total;
+}
+
+int main() {
+	//Random blocks of 2 to 13 rows and columns over 26 proteins
+	unsigned int random = 4242;
+	ProteinCollection my_graph (26);
+	for (int p = 0; p < 26; p++)
+		my_graph.add_protein("P" + std::to_string(p));
+	for (int p = 0; p < 13; p++)
+		for (int q = 13; q < 26; q++)
+			if ((random = random*1103515245 + 12345) % 10 < 4)
+				my_graph.connect_proteins("P" + std::to_string(p), "P" + std::to_string(q), 0.05 + ((random >> 16) % 95)/100.0);
+	long indexes[26];
+	for (int p = 0; p < 26; p++)
+		indexes[p] = my_graph.get_index("P" + std::to_string(p));
+
+	int trials = 0, solved_bound = 0, cheap_bound = 0, same_total = 0;
+	double stringencies[3] = {0, 0.1, 0.3};
+	for (int t = 0; t < 100; t++) {
+		int rows = 2 + (random = random*1103515245 + 12345) % 12;
+		int cols = 2 + (random = random*1103515245 + 12345) % 12;
+		SimilarityBlock block;
+		block.fill(indexes, rows, indexes + 13, cols, my_graph);
+
+		for (int s = 0; s < 3; s++) {
+			int length = std::max(rows, cols) - 1;
+			assignments_t porthodom = porthodom_assignments(block, stringencies[s]);
+			assignments_t assignments = porthodomO2_assignments(block, stringencies[s]);
+			double score = porthodomO2_scoring(assignments, length);
+			long long total = 0;
+			for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it)
+				total += it->second;
+
+			trials++;
+			//The bound from the solved porthodom total and from its own cheap bound
+			if (porthodomO2_upper_bound(block, stringencies[s], porthodom_total(porthodom), length) >= score)
+				solved_bound++;
+			if (porthodomO2_upper_bound(block, stringencies[s], porthodom_upper_bound(block, stringencies[s]), length) >= score)
+				cheap_bound++;
+			if (total == baseline_total(block, stringencies[s]))
+				same_total++;
+		}
+	}
+	std::cout << "scores under the bound of the porthodom total: " << solved_bound << "/" << trials << " (expected 300/300)\n";
+	std::cout << "scores under the bound of the porthodom bound: " << cheap_bound << "/" << trials << " (expected 300/300)\n";
+	std::cout << "totals equal to the ones with the extra zero column: " << same_total << "/" << trials
+	          << " (expected 300/300)\n";
+}
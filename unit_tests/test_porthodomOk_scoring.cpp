@@ -0,0 +1,66 @@
+#include "../src/porthodomOk_scoring.h"
+#include "../src/ProteinCollection.h"
+
+/*Returns the weight of the run of k proteins of g1 starting at i against the one of g2 starting at j, summed cell by
+ *cell along the diagonal of the block*/
+static int direct_value(const SimilarityBlock &block, int order, double prot_stringency, int i, int j) {
+	double sum = 0;
+	for (int t = 0; t < order; t++)
+		sum += block.at(i + t, j + t);
+	return sum/order >= prot_stringency ? (int)(1000000*(sum/order)) : 0;
+}
+
+int main() {
+	//Random blocks of 4 to 15 rows and columns over 30 proteins
+	unsigned int random = 99;
+	ProteinCollection my_graph (30);
+	for (int p = 0; p < 30; p++)
+		my_graph.add_protein("P" + std::to_string(p));
+	for (int p = 0; p < 15; p++)
+		for (int q = 15; q < 30; q++)
+			if ((random = random*1103515245 + 12345) % 10 < 4)
+				my_graph.connect_proteins("P" + std::to_string(p), "P" + std::to_string(q), 0.05 + ((random >> 16) % 95)/100.0);
+	long indexes[30];
+	for (int p = 0; p < 30; p++)
+		indexes[p] = my_graph.get_index("P" + std::to_string(p));
+
+	for (int order = 3; order <= 4; order++) {
+		int trials = 0, same_cells = 0, same_total = 0;
+		for (int t = 0; t < 100; t++) {
+			int rows = 4 + (random = random*1103515245 + 12345) % 12;
+			int cols = 4 + (random = random*1103515245 + 12345) % 12;
+			SimilarityBlock block;
+			block.fill(indexes, rows, indexes + 15, cols, my_graph);
+
+			//The assignments solved from the prefix sums...
+			assignments_t assignments = porthodomOk_assignments(block, order, 0.1);
+			long long total = 0;
+			bool cells = true;
+			for (assignments_t::iterator it = assignments.begin(); it != assignments.end(); ++it) {
+				total += it->second;
+				if (it->first.first <= rows - order && it->first.second <= cols - order) //not padding
+					cells = cells && std::abs(it->second - direct_value(block, order, 0.1, it->first.first, it->first.second)) <= 1;
+			}
+
+			//...and from the direct sums (up to the truncation of a last bit in each cell)
+			hungarian_matrix_t matrix(rows - order + 1, arena_vector<int>(cols - order + 1));
+			for (int i = 0; i <= rows - order; i++)
+				for (int j = 0; j <= cols - order; j++)
+					matrix[i][j] = direct_value(block, order, 0.1, i, j);
+			Hungarian my_hungarian (matrix, matrix.size(), matrix[0].size(), HUNGARIAN_MODE_MAXIMIZE_UTIL);
+			my_hungarian.solve();
+			assignments_t direct = my_hungarian.get_assignments();
+			long long direct_total = 0;
+			for (assignments_t::iterator it = direct.begin(); it != direct.end(); ++it)
+				direct_total += it->second;
+
+			trials++;
+			if (cells)
+				same_cells++;
+			if (std::llabs(total - direct_total) <= (long long)direct.size())
+				same_total++;
+		}
+		std::cout << "k=" << order << ": cells equal to the direct sums: " << same_cells << "/" << trials
+		          << " (expected 100/100), totals: " << same_total << "/" << trials << " (expected 100/100)\n";
+	}
+}